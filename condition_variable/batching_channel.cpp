@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <queue>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+#include "batching_channel.h"
+
+//g++ -std=c++20 -O2 -pthread batching_channel.cpp -o batching_channel
+
+//producer() / consumer() of readme.md : notify_one per item , one item per wakeup , plus a done flag to stop
+class cv_queue {
+public:
+    bool send(std::int64_t value) {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_queue.push(value);
+        }
+        m_cv.notify_one();
+        return true;
+    }
+
+    std::size_t receive(std::vector<std::int64_t>& out) {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_cv.wait(lock, [this] { return !m_queue.empty() || m_done; });
+        if (m_queue.empty()) return 0;
+        out.push_back(m_queue.front());
+        m_queue.pop();
+        return 1;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_done = true;
+        }
+        m_cv.notify_all();
+    }
+
+private:
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::queue<std::int64_t> m_queue;
+    bool m_done{false};
+};
+
+std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+//voluntary + involuntary context switches of the whole process so far
+long contextSwitches() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+//the work a producer does per message : without it the producers outrun the consumers ,
+//the queue is never empty and nobody sleeps
+void produceFor(std::chrono::nanoseconds work) {
+    const auto until = std::chrono::steady_clock::now() + work;
+    while (std::chrono::steady_clock::now() < until) {
+    }
+}
+
+struct Result {
+    double millionPerSecond;
+    double switchesPerMessage;
+    double meanLatencyMicros;
+};
+
+//every message is its send time , the consumers add up the delivery latency
+//batch == 1 --> send per item , otherwise send_batch of that many (the Channel must have it)
+template <typename Channel>
+Result run(Channel& channel, int producers, int consumers, int messagesPerProducer, int batch,
+           std::chrono::nanoseconds work) {
+    std::vector<std::int64_t> latencySum(consumers, 0);
+    std::vector<std::int64_t> received(consumers, 0);
+    const long switchesBefore{contextSwitches()};
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c] {
+            std::vector<std::int64_t> items;
+            while (channel.receive(items) != 0) {
+                const std::int64_t now{nowNs()};
+                for (std::int64_t sent : items) latencySum[c] += now - sent;
+                received[c] += static_cast<std::int64_t>(items.size());
+                items.clear();
+            }
+        });
+    }
+    std::vector<std::thread> senders;
+    for (int p = 0; p < producers; ++p) {
+        senders.emplace_back([&] {
+            if constexpr (requires { channel.send_batch(nullptr, nullptr); }) {
+                if (batch > 1) {
+                    std::vector<std::int64_t> pending(batch);
+                    for (int i = 0; i < messagesPerProducer; i += batch) {
+                        const int n{std::min(batch, messagesPerProducer - i)};
+                        for (int k = 0; k < n; ++k) {
+                            produceFor(work);
+                            pending[k] = nowNs();
+                        }
+                        channel.send_batch(pending.data(), pending.data() + n);
+                    }
+                    return;
+                }
+            }
+            for (int i = 0; i < messagesPerProducer; ++i) {
+                produceFor(work);
+                channel.send(nowNs());
+            }
+        });
+    }
+    for (auto& t : senders) t.join();
+    channel.close();
+    for (auto& t : threads) t.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const long switches{contextSwitches() - switchesBefore};
+
+    std::int64_t total{0}, latency{0};
+    for (int c = 0; c < consumers; ++c) {
+        total += received[c];
+        latency += latencySum[c];
+    }
+    return { total / seconds / 1e6, static_cast<double>(switches) / total, latency / 1000.0 / total };
+}
+
+void printRow(const char* name, const Result& r) {
+    std::cout << name << "\t" << r.millionPerSecond << "\t\t" << r.switchesPerMessage << "\t\t" << r.meanLatencyMicros
+              << "\n";
+}
+
+int main() {
+    //Example 2 of readme.md : the consumer gets 1..5 in one wakeup when the producer sends them as one batch
+    batching_channel<int> data_queue;
+    const int produced[]{ 1, 2, 3, 4, 5 };
+    data_queue.send_batch(std::begin(produced), std::end(produced));
+    data_queue.close();
+    std::vector<int> consumed;
+    while (data_queue.receive(consumed) != 0) {
+    }
+    std::cout << "Consumed " << consumed.size() << " items in " << data_queue.wakeups() << " wakeup(s)\n\n";
+
+    constexpr int producers = 2;
+    constexpr int consumers = 2;
+    constexpr int perProducer = 200'000;
+    constexpr std::chrono::nanoseconds work{1000};
+    std::cout << producers << " producers , " << consumers << " consumers , " << producers * perProducer
+              << " messages , " << work.count() << " ns of work per message\n";
+    std::cout << "channel\t\t\t\tMmsg/s\t\tctx switch/msg\tmean latency (us)\n";
+
+    cv_queue readme;
+    printRow("readme cv queue\t\t\t", run(readme, producers, consumers, perProducer, 1, work));
+
+    batching_channel<std::int64_t> perItem;
+    printRow("send , drain all\t\t", run(perItem, producers, consumers, perProducer, 1, work));
+
+    batching_channel<std::int64_t> batched;
+    printRow("send_batch 64 , drain all\t", run(batched, producers, consumers, perProducer, 64, work));
+
+    batching_channel<std::int64_t> lingering({ 256, std::chrono::microseconds{200} });
+    printRow("send , maxLatency 200us\t\t", run(lingering, producers, consumers, perProducer, 1, work));
+
+    batching_channel<std::int64_t> small({ 16, std::chrono::microseconds{0} });
+    printRow("send , maxBatch 16\t\t", run(small, producers, consumers, perProducer, 1, work));
+    return 0;
+}
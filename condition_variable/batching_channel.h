@@ -0,0 +1,153 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <stop_token>
+#include <vector>
+
+/*
+batching_channel<T> : the mtx + cv + data_queue of readme.md , with the handoff done per BATCH instead of per item
+-readme : producer() notifies per item , consumer() pops ONE item per wakeup --> one context switch per message
+-here :
+    send / send_batch : append under ONE lock acquisition , notify only on the empty --> non-empty transition
+        (later items find a consumer that is already awake or already notified)
+    receive : ONE wakeup drains everything available (up to maxBatch) into the caller's vector
+-knobs (BatchingOptions) :
+    maxBatch   : upper bound of one receive , the rest is left for the next call / another consumer
+    maxLatency : 0 --> receive returns as soon as there is something
+                 >0 --> receive lingers until maxBatch items are there or the oldest item is maxLatency old
+                        fewer wakeups per message , at most maxLatency more delay
+                        (the arrival time of every send / send_batch is kept : leftovers of a batch keep
+                        their own deadline , they do not start a new one)
+-close() : send is ignored afterwards , receive returns what is left , then 0
+-receive(out , stop_token) : returns 0 as soon as stop is requested , even while blocked or lingering
+    (m_cv is a condition_variable_any for its stop_token waits)
+*/
+
+struct BatchingOptions {
+    std::size_t maxBatch{256};
+    std::chrono::microseconds maxLatency{0};
+};
+
+template <typename T>
+class batching_channel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit batching_channel(BatchingOptions options = {}) : m_options{options} {
+        m_options.maxBatch = std::max<std::size_t>(1, m_options.maxBatch);
+    }
+
+    batching_channel(const batching_channel&) = delete;
+    batching_channel& operator=(const batching_channel&) = delete;
+
+    //false when closed
+    bool send(T value) {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        if (m_closed) return false;
+        m_items.push_back(std::move(value));
+        notifyAfterAppend(lock, 1);
+        return true;
+    }
+
+    //moves the whole range under one lock acquisition , false when closed
+    template <typename InputIt>
+    bool send_batch(InputIt first, InputIt last) {
+        if (first == last) return true;
+        std::unique_lock<std::mutex> lock(m_mtx);
+        if (m_closed) return false;
+        const std::size_t before{m_items.size()};
+        m_items.insert(m_items.end(), std::make_move_iterator(first), std::make_move_iterator(last));
+        notifyAfterAppend(lock, m_items.size() - before);
+        return true;
+    }
+
+    //appends up to maxBatch items to out , blocks while empty , returns 0 only when closed and drained
+    std::size_t receive(std::vector<T>& out) {
+        return receive(out, std::stop_token{}); //never stopped
+    }
+
+    //as receive , but returns 0 once stop is requested , the items stay for the other consumers
+    //the stop wakeup goes through the internal mutex of condition_variable_any , never through m_mtx :
+    //request_stop() runs it synchronously , from a thread that may hold anything
+    std::size_t receive(std::vector<T>& out, std::stop_token stop) {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        do {
+            m_cv.wait(lock, stop, [&] { return !m_items.empty() || m_closed; });
+            if (m_options.maxLatency.count() > 0 && !m_items.empty() && !stop.stop_requested()) {
+                m_cv.wait_until(lock, stop, m_arrivals.front().at + m_options.maxLatency,
+                                [&] { return m_items.size() >= m_options.maxBatch || m_closed; });
+            }
+            if (stop.stop_requested()) {
+                const bool items{!m_items.empty()};
+                lock.unlock();
+                if (items) m_cv.notify_one(); //we may have been the one consumer notified for them
+                return 0;
+            }
+        } while (m_items.empty() && !m_closed); //another consumer took the batch while we lingered
+        const std::size_t n{std::min(m_items.size(), m_options.maxBatch)};
+        out.insert(out.end(), std::make_move_iterator(m_items.begin()), std::make_move_iterator(m_items.begin() + n));
+        m_items.erase(m_items.begin(), m_items.begin() + n);
+        forgetArrivals(n);
+        const bool more{!m_items.empty()};
+        if (n != 0) ++m_wakeups;
+        lock.unlock();
+        if (more) m_cv.notify_one(); //leftovers : hand them to another consumer
+        return n;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_closed = true;
+        }
+        m_cv.notify_all();
+    }
+
+    //number of receive calls that returned items
+    std::size_t wakeups() const {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        return m_wakeups;
+    }
+
+private:
+    //called with the lock held , releases it before notifying
+    void notifyAfterAppend(std::unique_lock<std::mutex>& lock, std::size_t appended) {
+        const std::size_t size{m_items.size()};
+        const bool becameNonEmpty{size == appended};
+        if (m_options.maxLatency.count() > 0) m_arrivals.push_back({ appended, Clock::now() });
+        //a lingering consumer also wants to hear when the batch is full
+        const bool filledBatch{m_options.maxLatency.count() > 0 && size >= m_options.maxBatch &&
+                               size - appended < m_options.maxBatch};
+        lock.unlock();
+        if (becameNonEmpty || filledBatch) m_cv.notify_one();
+    }
+
+    //the n oldest items left : drop their arrival records , the front record is then the oldest item left
+    void forgetArrivals(std::size_t n) {
+        while (n != 0 && !m_arrivals.empty()) {
+            const std::size_t taken{std::min(n, m_arrivals.front().count)};
+            m_arrivals.front().count -= taken;
+            n -= taken;
+            if (m_arrivals.front().count == 0) m_arrivals.pop_front();
+        }
+    }
+
+    //one per send / send_batch , only with maxLatency > 0 : non-empty exactly when m_items is
+    struct Arrival {
+        std::size_t count;
+        Clock::time_point at;
+    };
+
+    BatchingOptions m_options;
+    mutable std::mutex m_mtx;
+    std::condition_variable_any m_cv;
+    std::deque<T> m_items;
+    std::deque<Arrival> m_arrivals;
+    std::size_t m_wakeups{0};
+    bool m_closed{false};
+};
@@ -0,0 +1,114 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include "mpmc_ring.h"
+
+//g++ -std=c++20 -O2 -pthread mpmc_ring.cpp -o mpmc_ring
+
+//data_queue + mtx + cv of readme.md , bounded to the same capacity as the ring so both apply backpressure
+template <typename T>
+class cv_queue {
+public:
+    explicit cv_queue(std::size_t capacity) : m_capacity{capacity} {}
+
+    void push(T value) {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_notFull.wait(lock, [this] { return m_queue.size() < m_capacity; });
+        m_queue.push(std::move(value));
+        lock.unlock();
+        m_notEmpty.notify_one();
+    }
+
+    void pop(T& out) {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_notEmpty.wait(lock, [this] { return !m_queue.empty(); });
+        out = std::move(m_queue.front());
+        m_queue.pop();
+        lock.unlock();
+        m_notFull.notify_one();
+    }
+
+private:
+    const std::size_t m_capacity;
+    std::mutex m_mtx;
+    std::condition_variable m_notFull;
+    std::condition_variable m_notEmpty;
+    std::queue<T> m_queue;
+};
+
+//every producer pushes its id in the high bits and a running number in the low bits ,
+//the consumers check that the numbers of each producer arrive in order and that nothing is lost
+template <typename Queue>
+double millionItemsPerSecond(int producers, int consumers, int itemsPerProducer, bool& ok) {
+    Queue queue(1024);
+    std::vector<std::uint64_t> sums(consumers, 0);
+    std::vector<char> inOrder(consumers, 1);
+    std::vector<std::thread> threads;
+    const std::int64_t total{static_cast<std::int64_t>(producers) * itemsPerProducer};
+    const auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c] {
+            std::vector<std::int64_t> last(producers, -1);
+            const std::int64_t share{total / consumers + (c < total % consumers ? 1 : 0)};
+            for (std::int64_t i = 0; i < share; ++i) {
+                std::uint64_t item;
+                queue.pop(item);
+                const auto producer{static_cast<int>(item >> 32)};
+                const auto number{static_cast<std::int64_t>(item & 0xffffffff)};
+                if (number <= last[producer]) inOrder[c] = 0;
+                last[producer] = number;
+                sums[c] += number;
+            }
+        });
+    }
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < itemsPerProducer; ++i) {
+                queue.push((static_cast<std::uint64_t>(p) << 32) | static_cast<std::uint64_t>(i));
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::uint64_t sum{0};
+    for (int c = 0; c < consumers; ++c) {
+        sum += sums[c];
+        ok = ok && inOrder[c];
+    }
+    ok = ok && sum == static_cast<std::uint64_t>(producers) * itemsPerProducer * (itemsPerProducer - 1) / 2;
+    return total / seconds / 1e6;
+}
+
+int main() {
+    //Example 2 of readme.md with the ring : consumer pops until the -1 sentinel
+    mpmc_ring<int> data_queue(8);
+    std::thread consumer([&] {
+        for (int value; (value = data_queue.pop()) != -1;) {
+            std::cout << "Consumed: " << value << "\n";
+        }
+    });
+    for (int i = 1; i <= 5; ++i) data_queue.push(i);
+    data_queue.push(-1);
+    consumer.join();
+    int leftover;
+    std::cout << "capacity(8) = " << data_queue.capacity() << " , try_pop on empty : " << std::boolalpha
+              << data_queue.try_pop(leftover) << "\n\n";
+
+    constexpr int totalItems = 2'000'000;
+    std::cout << "capacity 1024 , " << totalItems << " items , million items / s\n";
+    std::cout << "producers:consumers\tcv queue\tmpmc_ring\tspeed-up\n";
+    bool ok = true;
+    for (int n : { 1, 4, 16 }) {
+        const double cv = millionItemsPerSecond<cv_queue<std::uint64_t>>(n, n, totalItems / n, ok);
+        const double ring = millionItemsPerSecond<mpmc_ring<std::uint64_t>>(n, n, totalItems / n, ok);
+        std::cout << n << ":" << n << "\t\t\t" << cv << "\t\t" << ring << "\t\t" << ring / cv << "x\n";
+    }
+    std::cout << "every item once , per-producer order kept : " << ok << "\n";
+    return 0;
+}
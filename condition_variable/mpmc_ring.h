@@ -0,0 +1,215 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "ring_spin.h"
+
+/*
+mpmc_ring<T> : bounded multi-producer / multi-consumer queue , replaces std::queue data_queue + mtx + cv
+-capacity is rounded up to a power of two , every slot carries a sequence number :
+    sequence == pos            --> the slot is free for the producer that claims position pos
+    sequence == pos + 1        --> the slot holds the item of position pos , for the consumer that claims it
+    sequence == pos + capacity --> consumed , free again for the producer of the next lap
+-try_push / try_pop : claim a position with one CAS on m_enqueue / m_dequeue , then touch only that slot
+    --> producers and consumers never share a lock , and never wait for each other unless full / empty
+-push / pop : try , spin a little (multi-core only) , then park with atomic::wait
+    only when the ring is really full / empty
+-the other side wakes a parked thread only when a waiter exists :
+    waiter : ++m_popWaiters ; fence ; ticket = m_pushEvents ; try_pop again ; m_pushEvents.wait(ticket)
+    pusher : publish the slot ; fence ; if m_popWaiters != 0 --> --m_popWaiters , ++m_pushEvents , notify_one
+    either the waiter sees the item , or the pusher sees the waiter (and the ticket has changed)
+    the pusher (not the woken thread) decrements the count --> the next pushes do not wake it again
+-push / pop with a stop_token : false once stop is requested , the stop callback bumps the events word
+    of the parked side and notifies all --> the ticket has changed , no wakeup can be lost
+-FIFO per producer , not a global order between producers
+*/
+
+namespace mpmc_detail {
+    inline constexpr int SpinRounds{128};
+
+    inline std::size_t roundUpToPowerOfTwo(std::size_t n) {
+        std::size_t capacity{2};
+        while (capacity < n) capacity <<= 1;
+        return capacity;
+    }
+}
+
+template <typename T>
+class mpmc_ring {
+public:
+    explicit mpmc_ring(std::size_t capacity)
+        : m_mask{mpmc_detail::roundUpToPowerOfTwo(checkedCapacity(capacity)) - 1}, m_slots{new Slot[m_mask + 1]} {
+        for (std::size_t i = 0; i <= m_mask; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~mpmc_ring() {
+        T drained;
+        while (try_pop(drained)) {
+        }
+        delete[] m_slots;
+    }
+
+    mpmc_ring(const mpmc_ring&) = delete;
+    mpmc_ring& operator=(const mpmc_ring&) = delete;
+
+    std::size_t capacity() const noexcept { return m_mask + 1; }
+
+    //false when full
+    template <typename U>
+    bool try_push(U&& value) {
+        std::size_t pos{m_enqueue.load(std::memory_order_relaxed)};
+        Slot* slot;
+        for (;;) {
+            slot = &m_slots[pos & m_mask];
+            const std::size_t sequence{slot->sequence.load(std::memory_order_acquire)};
+            const auto diff{static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos)};
+            if (diff == 0) {
+                if (m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; //the slot of the previous lap is not consumed yet
+            } else {
+                pos = m_enqueue.load(std::memory_order_relaxed); //another producer took pos
+            }
+        }
+        ::new (slot->storage) T(std::forward<U>(value));
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        wakeOne(m_popWaiters, m_pushEvents);
+        return true;
+    }
+
+    //false when empty (or when the oldest claimed item is still being written)
+    bool try_pop(T& out) {
+        std::size_t pos{m_dequeue.load(std::memory_order_relaxed)};
+        Slot* slot;
+        for (;;) {
+            slot = &m_slots[pos & m_mask];
+            const std::size_t sequence{slot->sequence.load(std::memory_order_acquire)};
+            const auto diff{static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1)};
+            if (diff == 0) {
+                if (m_dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_dequeue.load(std::memory_order_relaxed);
+            }
+        }
+        T* item{std::launder(reinterpret_cast<T*>(slot->storage))};
+        out = std::move(*item);
+        item->~T();
+        slot->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        wakeOne(m_pushWaiters, m_popEvents);
+        return true;
+    }
+
+    template <typename U>
+    void push(U&& value) {
+        //try_push only forwards once it has a slot , so value is still intact after a failed try
+        blockUntil([&] { return try_push(std::forward<U>(value)); }, m_pushWaiters, m_popEvents);
+    }
+
+    void pop(T& out) {
+        blockUntil([&] { return try_pop(out); }, m_popWaiters, m_pushEvents);
+    }
+
+    T pop() {
+        T out;
+        pop(out);
+        return out;
+    }
+
+    //false when stop was requested before a slot was free , value is then untouched
+    template <typename U>
+    bool push(U&& value, std::stop_token stop) {
+        return blockUntil([&] { return try_push(std::forward<U>(value)); }, m_pushWaiters, m_popEvents, stop);
+    }
+
+    //false when stop was requested before an item came
+    bool pop(T& out, std::stop_token stop) {
+        return blockUntil([&] { return try_pop(out); }, m_popWaiters, m_pushEvents, stop);
+    }
+
+    //a hint only : the positions move while it is read
+    std::size_t size_approx() const noexcept {
+        const std::size_t dequeue{m_dequeue.load(std::memory_order_relaxed)};
+        const std::size_t enqueue{m_enqueue.load(std::memory_order_relaxed)};
+        return enqueue > dequeue ? enqueue - dequeue : 0;
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    static std::size_t checkedCapacity(std::size_t capacity) {
+        if (capacity == 0 || capacity > (std::size_t{1} << (sizeof(std::size_t) * 8 - 2))) {
+            throw std::invalid_argument("mpmc_ring capacity must be in [1 , 2^62]");
+        }
+        return capacity;
+    }
+
+    //a waiter registers once per sleep , the waker that wakes it takes the registration back
+    //false only when stop is requested (a default stop_token never is)
+    template <typename Attempt>
+    static bool blockUntil(Attempt attempt, std::atomic<std::uint32_t>& waiters, std::atomic<std::uint32_t>& events,
+                           std::stop_token stop = {}) {
+        for (int i = 0; i < mpmc_detail::SpinRounds && ring_detail::spinningHelps(); ++i) {
+            if (attempt()) return true;
+            if (stop.stop_requested()) return false;
+            ring_detail::cpuRelax();
+        }
+        //wakes every thread parked on this side , the others find their ticket changed and park again
+        std::stop_callback interrupt{stop, [&events] {
+            events.fetch_add(1, std::memory_order_release);
+            events.notify_all();
+        }};
+        for (;;) {
+            waiters.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::uint32_t ticket{events.load(std::memory_order_acquire)};
+            if (attempt()) {
+                takeRegistration(waiters); //unless a waker already did
+                return true;
+            }
+            if (stop.stop_requested()) {
+                takeRegistration(waiters);
+                return false;
+            }
+            events.wait(ticket, std::memory_order_acquire);
+        }
+    }
+
+    static bool takeRegistration(std::atomic<std::uint32_t>& waiters) {
+        for (std::uint32_t n{waiters.load(std::memory_order_relaxed)}; n != 0;) {
+            if (waiters.compare_exchange_weak(n, n - 1, std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+
+    //the fence pairs with the one in blockUntil , nothing but a load while nobody sleeps
+    //a burst of pushes into a ring with one sleeping consumer costs ONE notify , not one per item
+    static void wakeOne(std::atomic<std::uint32_t>& waiters, std::atomic<std::uint32_t>& events) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) != 0 && takeRegistration(waiters)) {
+            events.fetch_add(1, std::memory_order_release);
+            events.notify_one();
+        }
+    }
+
+    const std::size_t m_mask;
+    Slot* const m_slots;
+    alignas(64) std::atomic<std::size_t> m_enqueue{0};
+    alignas(64) std::atomic<std::size_t> m_dequeue{0};
+    alignas(64) std::atomic<std::uint32_t> m_pushWaiters{0};  //producers parked on a full ring
+    std::atomic<std::uint32_t> m_popEvents{0};                //bumped by pops while m_pushWaiters != 0
+    alignas(64) std::atomic<std::uint32_t> m_popWaiters{0};   //consumers parked on an empty ring
+    std::atomic<std::uint32_t> m_pushEvents{0};
+};
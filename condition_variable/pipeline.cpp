@@ -0,0 +1,93 @@
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pipeline.h"
+
+//g++ -std=c++20 -O2 -pthread pipeline.cpp -o pipeline
+
+//move-only items : every stage takes the unique_ptr and passes it on
+struct Document {
+    int id;
+    std::string text;
+    std::vector<std::string> words;
+    int score{0};
+};
+using DocumentPtr = std::unique_ptr<Document>;
+
+//CPU : split the text into words
+DocumentPtr tokenize(DocumentPtr doc) {
+    if (doc->text.empty()) throw std::runtime_error("document " + std::to_string(doc->id) + " is empty");
+    std::istringstream in(doc->text);
+    for (std::string word; in >> word;) doc->words.push_back(std::move(word));
+    return doc;
+}
+
+//I/O : a remote lookup , 200us of waiting per document --> more threads help even on one core
+DocumentPtr lookup(DocumentPtr doc) {
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+    doc->score = static_cast<int>(doc->words.size());
+    return doc;
+}
+
+DocumentPtr makeDocument(int id) {
+    const std::string text{"the quick brown fox jumps over the lazy dog " + std::to_string(id)};
+    return std::make_unique<Document>(Document{ id, text, {} });
+}
+
+//one run : the lookup stage gets lookupThreads workers
+double run(int documents, int lookupThreads) {
+    std::map<std::string, int> wordCount; //only the single sink thread touches it
+    auto pipeline = makePipeline<DocumentPtr>(64)
+                        .stage("tokenize", 1, tokenize)
+                        .stage("lookup", lookupThreads, lookup)
+                        .sink("count", 1, [&wordCount](DocumentPtr doc) {
+                            for (const auto& word : doc->words) ++wordCount[word];
+                        });
+    const auto start = std::chrono::steady_clock::now();
+    for (int id = 0; id < documents; ++id) {
+        pipeline.push(makeDocument(id));
+        if (id == documents / 2) {
+            std::cout << "-- halfway , lookup x" << lookupThreads << "\n";
+            pipeline.printMetrics(std::cout);
+        }
+    }
+    pipeline.close();
+    pipeline.wait(); //ordered : tokenize drains , then lookup , then count
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "-- done , \"the\" counted " << wordCount["the"] << " times (expected " << 2 * documents << ")\n";
+    pipeline.printMetrics(std::cout);
+    std::cout << "\n";
+    return documents / seconds;
+}
+
+int main() {
+    //the first error is rethrown by wait() , the other items still reach the sink
+    {
+        int stored = 0;
+        auto pipeline = makePipeline<DocumentPtr>(8)
+                            .stage("tokenize", 2, tokenize)
+                            .sink("store", 1, [&stored](DocumentPtr) { ++stored; });
+        for (int id = 0; id < 10; ++id) {
+            pipeline.push(id == 3 ? std::make_unique<Document>(Document{ id, "", {} }) : makeDocument(id));
+        }
+        pipeline.close();
+        try {
+            pipeline.wait();
+        } catch (const std::exception& e) {
+            std::cout << "wait() rethrew : " << e.what() << " , stored " << stored << " of 10 , errors "
+                      << pipeline.metrics()[0].errors << "\n\n";
+        }
+    }
+
+    constexpr int documents = 4000;
+    const double one = run(documents, 1);
+    const double eight = run(documents, 8);
+    std::cout << "documents/s : lookup x1 " << one << " , lookup x8 " << eight << " (" << eight / one << "x)\n";
+    return 0;
+}
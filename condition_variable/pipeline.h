@@ -0,0 +1,353 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+Pipeline : chains producer / consumer stages of readme.md without writing the queue , threads and shutdown each time
+    auto pipeline = makePipeline<Request>(64)                       //64 = capacity of every queue
+                        .stage("parse", 2, [](Request r) { return parse(std::move(r)); })
+                        .stage("enrich", 8, [](Record r) { return enrich(std::move(r)); })
+                        .sink("store", 1, [](Record r) { store(std::move(r)); });
+    pipeline.push(request); ... pipeline.close(); pipeline.wait();
+-every stage = a callable + a parallelism degree (that many worker threads)
+-between two stages : a BOUNDED queue (mtx + 2 condition_variables) --> a slow stage blocks the one before it
+    (backpressure) instead of letting its input grow without limit
+-items are MOVED from queue to callable to the next queue , move-only types (unique_ptr ...) work
+-ordered shutdown : close() closes the first queue , the workers of a stage drain their input ,
+    the LAST one to leave closes the next queue --> every item pushed before close() reaches the sink
+-an exception thrown by a callable drops that item , is counted , and the first one is rethrown by wait()
+-metrics() while running : per stage items , items/s , utilization (busy time / (threads * elapsed)) ,
+    input queue depth (now / max / mean at push) , time blocked on a full output queue
+    the bottleneck is the stage with the highest utilization among those whose input queue filled up
+    (max depth == capacity) , none is marked when no input queue ever filled up : the producer is the limit
+    elapsed stops when the last worker of the stage leaves : the rates of a finished stage stay put
+*/
+
+struct StageMetrics {
+    std::string name;
+    int parallelism{0};
+    std::uint64_t processed{0};
+    std::uint64_t errors{0};
+    double itemsPerSecond{0};
+    double utilization{0};       //0..1 , busy time of all workers / (workers * elapsed)
+    std::size_t queueDepth{0};   //input queue , now
+    std::size_t maxQueueDepth{0};
+    std::size_t queueCapacity{0};
+    double meanQueueDepth{0};    //seen by each push
+    double blockedSeconds{0};    //waiting for room in the output queue (all workers)
+};
+
+namespace pipeline_detail {
+    using Clock = std::chrono::steady_clock;
+
+    inline std::int64_t nanosSince(Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+    //the readme data_queue + mtx + cv , bounded , closable
+    template <typename T>
+    class bounded_queue {
+    public:
+        explicit bounded_queue(std::size_t capacity) : m_capacity{std::max<std::size_t>(1, capacity)} {}
+
+        //blocks while full , false when closed (the item is dropped)
+        bool push(T&& value) {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            m_notFull.wait(lock, [this] { return m_items.size() < m_capacity || m_closed; });
+            if (m_closed) return false;
+            m_items.push_back(std::move(value));
+            const std::size_t depth{m_items.size()};
+            m_maxDepth = std::max(m_maxDepth, depth);
+            m_depthSum += depth;
+            ++m_pushes;
+            lock.unlock();
+            m_notEmpty.notify_one();
+            return true;
+        }
+
+        //blocks while empty , nullopt when closed and drained
+        std::optional<T> pop() {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            m_notEmpty.wait(lock, [this] { return !m_items.empty() || m_closed; });
+            if (m_items.empty()) return std::nullopt;
+            std::optional<T> value{std::move(m_items.front())};
+            m_items.pop_front();
+            lock.unlock();
+            m_notFull.notify_one();
+            return value;
+        }
+
+        void close() {
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                m_closed = true;
+            }
+            m_notEmpty.notify_all();
+            m_notFull.notify_all();
+        }
+
+        void fillMetrics(StageMetrics& metrics) const {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            metrics.queueDepth = m_items.size();
+            metrics.maxQueueDepth = m_maxDepth;
+            metrics.queueCapacity = m_capacity;
+            metrics.meanQueueDepth = m_pushes == 0 ? 0.0 : static_cast<double>(m_depthSum) / m_pushes;
+        }
+
+    private:
+        const std::size_t m_capacity;
+        mutable std::mutex m_mtx;
+        std::condition_variable m_notEmpty;
+        std::condition_variable m_notFull;
+        std::deque<T> m_items;
+        std::size_t m_maxDepth{0};
+        std::uint64_t m_depthSum{0};
+        std::uint64_t m_pushes{0};
+        bool m_closed{false};
+    };
+
+    template <>
+    class bounded_queue<void> {}; //the sink has no output queue
+
+    class StageBase {
+    public:
+        StageBase(std::string name, int parallelism) : m_name{std::move(name)}, m_parallelism{std::max(1, parallelism)} {}
+        virtual ~StageBase() = default;
+
+        void start(Clock::time_point started) {
+            m_started = started;
+            m_running.store(m_parallelism, std::memory_order_relaxed);
+            for (int i = 0; i < m_parallelism; ++i) {
+                m_workers.emplace_back([this] { run(); });
+            }
+        }
+
+        void join() {
+            for (auto& w : m_workers) {
+                if (w.joinable()) w.join();
+            }
+        }
+
+        std::exception_ptr firstError() const {
+            std::lock_guard<std::mutex> lock(m_errorMtx);
+            return m_firstError;
+        }
+
+        StageMetrics metrics() const {
+            StageMetrics m;
+            m.name = m_name;
+            m.parallelism = m_parallelism;
+            m.processed = m_processed.load(std::memory_order_relaxed);
+            m.errors = m_errors.load(std::memory_order_relaxed);
+            const std::int64_t stopped{m_stoppedNanos.load(std::memory_order_acquire)};
+            const double elapsed{static_cast<double>(std::max<std::int64_t>(1, stopped != 0 ? stopped
+                                                                                            : nanosSince(m_started)))};
+            m.itemsPerSecond = m.processed / elapsed * 1e9;
+            m.utilization = m_busyNanos.load(std::memory_order_relaxed) / (elapsed * m_parallelism);
+            m.blockedSeconds = m_blockedNanos.load(std::memory_order_relaxed) / 1e9;
+            fillQueueMetrics(m);
+            return m;
+        }
+
+    protected:
+        //one item : false when the input is closed and drained
+        virtual bool processOne() = 0;
+        virtual void closeOutput() = 0;
+        virtual void fillQueueMetrics(StageMetrics& metrics) const = 0;
+
+        void recordError(std::exception_ptr error) {
+            m_errors.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(m_errorMtx);
+            if (!m_firstError) m_firstError = error;
+        }
+
+        std::atomic<std::uint64_t> m_processed{0};
+        std::atomic<std::int64_t> m_busyNanos{0};
+        std::atomic<std::int64_t> m_blockedNanos{0};
+
+    private:
+        void run() {
+            while (processOne()) {
+            }
+            if (m_running.fetch_sub(1, std::memory_order_acq_rel) == 1) { //the last one out
+                m_stoppedNanos.store(std::max<std::int64_t>(1, nanosSince(m_started)), std::memory_order_release);
+                closeOutput();
+            }
+        }
+
+        const std::string m_name;
+        const int m_parallelism;
+        std::vector<std::thread> m_workers;
+        std::atomic<int> m_running{0};
+        Clock::time_point m_started{};
+        std::atomic<std::int64_t> m_stoppedNanos{0}; //elapsed when the last worker left , 0 while running
+        std::atomic<std::uint64_t> m_errors{0};
+        mutable std::mutex m_errorMtx;
+        std::exception_ptr m_firstError;
+    };
+
+    //In --> fn --> Out , Out == void for the sink (no output queue)
+    template <typename In, typename Out, typename Fn>
+    class Stage final : public StageBase {
+    public:
+        Stage(std::string name, int parallelism, Fn fn, std::shared_ptr<bounded_queue<In>> input,
+              std::shared_ptr<bounded_queue<Out>> output)
+            : StageBase{std::move(name), parallelism}, m_fn{std::move(fn)}, m_input{std::move(input)},
+              m_output{std::move(output)} {}
+
+    private:
+        bool processOne() override {
+            std::optional<In> item{m_input->pop()};
+            if (!item) return false;
+            const auto start{Clock::now()};
+            try {
+                if constexpr (std::is_void_v<Out>) {
+                    m_fn(std::move(*item));
+                    m_busyNanos.fetch_add(nanosSince(start), std::memory_order_relaxed);
+                    m_processed.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    Out result{m_fn(std::move(*item))};
+                    const auto done{Clock::now()};
+                    m_busyNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(done - start).count(),
+                                          std::memory_order_relaxed);
+                    //cannot fail : only this stage closes its output , after its last worker left processOne()
+                    m_output->push(std::move(result));
+                    m_blockedNanos.fetch_add(nanosSince(done), std::memory_order_relaxed);
+                    m_processed.fetch_add(1, std::memory_order_relaxed);
+                }
+            } catch (...) {
+                m_busyNanos.fetch_add(nanosSince(start), std::memory_order_relaxed);
+                recordError(std::current_exception());
+            }
+            return true;
+        }
+
+        void closeOutput() override {
+            if constexpr (!std::is_void_v<Out>) m_output->close();
+        }
+
+        void fillQueueMetrics(StageMetrics& metrics) const override { m_input->fillMetrics(metrics); }
+
+        Fn m_fn;
+        std::shared_ptr<bounded_queue<In>> m_input;
+        std::shared_ptr<bounded_queue<Out>> m_output;
+    };
+}
+
+template <typename In>
+class Pipeline {
+public:
+    Pipeline(std::shared_ptr<pipeline_detail::bounded_queue<In>> input,
+             std::vector<std::unique_ptr<pipeline_detail::StageBase>> stages)
+        : m_input{std::move(input)}, m_stages{std::move(stages)} {
+        const auto started{pipeline_detail::Clock::now()};
+        for (auto& stage : m_stages) stage->start(started);
+    }
+
+    Pipeline(Pipeline&&) = default;
+    Pipeline& operator=(Pipeline&&) = delete;
+
+    ~Pipeline() {
+        if (!m_input) return; //moved from
+        close();
+        for (auto& stage : m_stages) stage->join();
+    }
+
+    //blocks while the first queue is full , false after close()
+    bool push(In value) { return m_input->push(std::move(value)); }
+
+    void close() { m_input->close(); }
+
+    //joins stage by stage , in order , then rethrows the first error of the first failing stage
+    void wait() {
+        for (auto& stage : m_stages) stage->join();
+        for (auto& stage : m_stages) {
+            if (auto error = stage->firstError()) std::rethrow_exception(error);
+        }
+    }
+
+    std::vector<StageMetrics> metrics() const {
+        std::vector<StageMetrics> result;
+        for (const auto& stage : m_stages) result.push_back(stage->metrics());
+        return result;
+    }
+
+    void printMetrics(std::ostream& out) const {
+        const auto all{metrics()};
+        //the busiest stage among those whose input queue filled up , all.size() = none
+        std::size_t bottleneck{all.size()};
+        for (std::size_t i = 0; i < all.size(); ++i) {
+            const bool filledUp{all[i].maxQueueDepth >= all[i].queueCapacity};
+            if (filledUp && (bottleneck == all.size() || all[i].utilization > all[bottleneck].utilization)) {
+                bottleneck = i;
+            }
+        }
+        out << "stage\tthreads\titems\titems/s\tbusy\tqueue now/max/mean\tblocked (s)\n";
+        for (std::size_t i = 0; i < all.size(); ++i) {
+            const auto& m{all[i]};
+            out << m.name << "\t" << m.parallelism << "\t" << m.processed << "\t"
+                << static_cast<std::int64_t>(m.itemsPerSecond) << "\t" << static_cast<int>(m.utilization * 100 + 0.5)
+                << "%\t" << m.queueDepth << "/" << m.maxQueueDepth << "/" << static_cast<int>(m.meanQueueDepth + 0.5)
+                << "\t\t" << m.blockedSeconds << (i == bottleneck ? "\t<-- bottleneck" : "") << "\n";
+        }
+    }
+
+private:
+    std::shared_ptr<pipeline_detail::bounded_queue<In>> m_input;
+    std::vector<std::unique_ptr<pipeline_detail::StageBase>> m_stages;
+};
+
+//In = what push() takes , Out = what the last stage added so far produces
+template <typename In, typename Out>
+class PipelineBuilder {
+public:
+    PipelineBuilder(std::size_t queueCapacity, std::shared_ptr<pipeline_detail::bounded_queue<In>> input,
+                    std::shared_ptr<pipeline_detail::bounded_queue<Out>> tail,
+                    std::vector<std::unique_ptr<pipeline_detail::StageBase>> stages)
+        : m_capacity{queueCapacity}, m_input{std::move(input)}, m_tail{std::move(tail)}, m_stages{std::move(stages)} {}
+
+    template <typename Fn>
+    auto stage(std::string name, int parallelism, Fn fn) && {
+        using Next = std::decay_t<std::invoke_result_t<Fn&, Out&&>>;
+        static_assert(!std::is_void_v<Next>, "a middle stage must return the item for the next stage , use sink()");
+        auto output{std::make_shared<pipeline_detail::bounded_queue<Next>>(m_capacity)};
+        m_stages.push_back(std::make_unique<pipeline_detail::Stage<Out, Next, Fn>>(std::move(name), parallelism,
+                                                                                    std::move(fn), m_tail, output));
+        return PipelineBuilder<In, Next>{m_capacity, std::move(m_input), std::move(output), std::move(m_stages)};
+    }
+
+    //the last stage , starts every worker
+    template <typename Fn>
+    Pipeline<In> sink(std::string name, int parallelism, Fn fn) && {
+        m_stages.push_back(std::make_unique<pipeline_detail::Stage<Out, void, Fn>>(
+            std::move(name), parallelism, std::move(fn), m_tail, nullptr));
+        return Pipeline<In>{std::move(m_input), std::move(m_stages)};
+    }
+
+private:
+    std::size_t m_capacity;
+    std::shared_ptr<pipeline_detail::bounded_queue<In>> m_input;
+    std::shared_ptr<pipeline_detail::bounded_queue<Out>> m_tail;
+    std::vector<std::unique_ptr<pipeline_detail::StageBase>> m_stages;
+};
+
+template <typename In>
+PipelineBuilder<In, In> makePipeline(std::size_t queueCapacity) {
+    auto input{std::make_shared<pipeline_detail::bounded_queue<In>>(queueCapacity)};
+    return PipelineBuilder<In, In>{queueCapacity, input, input, {}};
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <thread>
+
+//the spin half of spin-then-park , shared by mpmc_ring.h and spsc_ring.h
+namespace ring_detail {
+    inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    //on one core the thread we spin for cannot run , park immediately
+    inline bool spinningHelps() {
+        static const bool multiCore{std::thread::hardware_concurrency() > 1};
+        return multiCore;
+    }
+}
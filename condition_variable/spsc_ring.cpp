@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include "spsc_ring.h"
+
+//g++ -std=c++20 -O2 -pthread spsc_ring.cpp -o spsc_ring
+
+//producer() / consumer() of readme.md : data_queue + mtx + cv , notify_one per item
+class cv_queue {
+public:
+    void push(std::uint64_t value) {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_queue.push(value);
+        }
+        m_cv.notify_one();
+    }
+
+    std::uint64_t pop() {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_cv.wait(lock, [this] { return !m_queue.empty(); });
+        const std::uint64_t value{m_queue.front()};
+        m_queue.pop();
+        return value;
+    }
+
+private:
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::queue<std::uint64_t> m_queue;
+};
+
+//runs producer and consumer on two threads , the consumer checks the order , returns million messages / s
+template <typename Produce, typename Consume>
+double millionMessagesPerSecond(std::uint64_t count, Produce produce, Consume consume, bool& ok) {
+    const auto start = std::chrono::steady_clock::now();
+    std::thread consumer([&] {
+        std::uint64_t expected{0};
+        consume([&](std::uint64_t value) {
+            if (value != expected) ok = false;
+            ++expected;
+        });
+    });
+    std::thread producer(produce);
+    producer.join();
+    consumer.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return count / seconds / 1e6;
+}
+
+//the wait-free ring never blocks : the caller decides what to do when full / empty
+//(pause on a multi-core machine , yield on one core where the other side needs this core)
+inline void backOff() {
+    if (ring_detail::spinningHelps()) {
+        ring_detail::cpuRelax();
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+int main() {
+    //producer() / consumer() of readme.md with the blocking ring
+    blocking_spsc_ring<int> data_queue(4);
+    std::thread consumer([&] {
+        for (int value; (value = data_queue.pop()) != -1;) {
+            std::cout << "Consumed: " << value << "\n";
+        }
+    });
+    const int batch[]{ 1, 2, 3, 4, 5 };
+    data_queue.push_n(batch, 5); //more than the capacity : waits for room once
+    data_queue.push(-1);
+    consumer.join();
+    std::cout << "\n";
+
+    constexpr std::uint64_t count = 10'000'000;
+    constexpr std::size_t capacity = 4096;
+    constexpr std::size_t batchSize = 64;
+    bool ok = true;
+    std::cout << count << " messages , capacity " << capacity << " , one producer , one consumer\n";
+
+    cv_queue cvQueue;
+    const double cv = millionMessagesPerSecond(
+        count / 10, [&] { for (std::uint64_t i = 0; i < count / 10; ++i) cvQueue.push(i); },
+        [&](auto check) { for (std::uint64_t i = 0; i < count / 10; ++i) check(cvQueue.pop()); }, ok);
+    std::cout << "readme cv queue              : " << cv << " Mmsg/s\n";
+
+    spsc_ring<std::uint64_t> ring(capacity);
+    const double spin = millionMessagesPerSecond(
+        count,
+        [&] {
+            for (std::uint64_t i = 0; i < count; ++i) {
+                while (!ring.try_push(i)) backOff();
+            }
+        },
+        [&](auto check) {
+            for (std::uint64_t i = 0, value; i < count; ++i) {
+                while (!ring.try_pop(value)) backOff();
+                check(value);
+            }
+        },
+        ok);
+    std::cout << "spsc_ring try_push / try_pop : " << spin << " Mmsg/s\n";
+
+    const double spinBatch = millionMessagesPerSecond(
+        count,
+        [&] {
+            std::uint64_t items[batchSize];
+            for (std::uint64_t i = 0; i < count;) {
+                const std::size_t n{std::min<std::uint64_t>(batchSize, count - i)};
+                for (std::size_t k = 0; k < n; ++k) items[k] = i + k;
+                for (std::size_t done = 0; done < n;) {
+                    const std::size_t pushed{ring.push_n(items + done, n - done)};
+                    if (pushed == 0) backOff();
+                    done += pushed;
+                }
+                i += n;
+            }
+        },
+        [&](auto check) {
+            std::uint64_t items[batchSize];
+            for (std::uint64_t i = 0; i < count;) {
+                const std::size_t n{ring.pop_n(items, batchSize)};
+                if (n == 0) backOff();
+                for (std::size_t k = 0; k < n; ++k) check(items[k]);
+                i += n;
+            }
+        },
+        ok);
+    std::cout << "spsc_ring push_n / pop_n " << batchSize << "  : " << spinBatch << " Mmsg/s\n";
+
+    blocking_spsc_ring<std::uint64_t> blocking(capacity);
+    const double blocked = millionMessagesPerSecond(
+        count, [&] { for (std::uint64_t i = 0; i < count; ++i) blocking.push(i); },
+        [&](auto check) { for (std::uint64_t i = 0; i < count; ++i) check(blocking.pop()); }, ok);
+    std::cout << "blocking push / pop          : " << blocked << " Mmsg/s\n";
+
+    const double blockedBatch = millionMessagesPerSecond(
+        count,
+        [&] {
+            std::uint64_t items[batchSize];
+            for (std::uint64_t i = 0; i < count; i += batchSize) {
+                for (std::size_t k = 0; k < batchSize; ++k) items[k] = i + k;
+                blocking.push_n(items, std::min<std::uint64_t>(batchSize, count - i));
+            }
+        },
+        [&](auto check) {
+            std::uint64_t items[batchSize];
+            for (std::uint64_t i = 0; i < count;) {
+                const std::size_t n{blocking.pop_n(items, batchSize)};
+                for (std::size_t k = 0; k < n; ++k) check(items[k]);
+                i += n;
+            }
+        },
+        ok);
+    std::cout << "blocking push_n / pop_n " << batchSize << "   : " << blockedBatch << " Mmsg/s\n";
+    std::cout << "every message once , in order : " << std::boolalpha << ok << "\n";
+    return 0;
+}
@@ -0,0 +1,241 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include "ring_spin.h"
+
+/*
+spsc_ring<T> : bounded single-producer / single-consumer queue , for the producer() / consumer() pair of readme.md
+-exactly ONE thread pushes and ONE thread pops , nothing else is checked
+-wait-free : every call finishes in a bounded number of steps , no CAS , no lock
+-m_tail (written by the producer) and m_head (written by the consumer) live on separate cache lines
+-each side keeps a plain copy of the OTHER side's index (m_cachedHead / m_cachedTail) on its own line
+    --> the shared line is read only when the copy says full / empty , not on every call
+-push_n / pop_n move a whole batch and publish it with ONE release store
+-blocking_spsc_ring<T> adds push / pop that park on atomic::wait , the plain ring never blocks
+*/
+
+namespace spsc_detail {
+    inline constexpr int SpinRounds{256};
+}
+
+template <typename T>
+class spsc_ring {
+public:
+    explicit spsc_ring(std::size_t capacity)
+        : m_mask{roundUpToPowerOfTwo(capacity) - 1}, m_slots{new Slot[m_mask + 1]} {}
+
+    ~spsc_ring() {
+        const std::size_t tail{m_tail.load(std::memory_order_relaxed)};
+        for (std::size_t i = m_head.load(std::memory_order_relaxed); i != tail; ++i) {
+            item(i)->~T();
+        }
+        delete[] m_slots;
+    }
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    std::size_t capacity() const noexcept { return m_mask + 1; }
+
+    //producer only , false when full
+    template <typename U>
+    bool try_push(U&& value) {
+        const std::size_t tail{m_tail.load(std::memory_order_relaxed)};
+        if (tail - m_cachedHead == capacity()) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead == capacity()) return false;
+        }
+        ::new (m_slots[tail & m_mask].storage) T(std::forward<U>(value));
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //producer only : moves up to count items from first , returns how many were pushed
+    template <typename InputIt>
+    std::size_t push_n(InputIt first, std::size_t count) {
+        const std::size_t tail{m_tail.load(std::memory_order_relaxed)};
+        std::size_t free{capacity() - (tail - m_cachedHead)};
+        if (free < count) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            free = capacity() - (tail - m_cachedHead);
+        }
+        const std::size_t n{std::min(free, count)};
+        for (std::size_t i = 0; i < n; ++i, ++first) {
+            ::new (m_slots[(tail + i) & m_mask].storage) T(std::move(*first));
+        }
+        if (n != 0) m_tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    //consumer only , false when empty
+    bool try_pop(T& out) {
+        const std::size_t head{m_head.load(std::memory_order_relaxed)};
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) return false;
+        }
+        T* value{item(head)};
+        out = std::move(*value);
+        value->~T();
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    //consumer only : moves up to maxCount items to out , returns how many were popped
+    template <typename OutputIt>
+    std::size_t pop_n(OutputIt out, std::size_t maxCount) {
+        const std::size_t head{m_head.load(std::memory_order_relaxed)};
+        std::size_t available{m_cachedTail - head};
+        if (available < maxCount) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            available = m_cachedTail - head;
+        }
+        const std::size_t n{std::min(available, maxCount)};
+        for (std::size_t i = 0; i < n; ++i, ++out) {
+            T* value{item(head + i)};
+            *out = std::move(*value);
+            value->~T();
+        }
+        if (n != 0) m_head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    //exact from either side's own point of view , a hint for anybody else
+    std::size_t size_approx() const noexcept {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t n) {
+        if (n == 0 || n > (std::size_t{1} << (sizeof(std::size_t) * 8 - 2))) {
+            throw std::invalid_argument("spsc_ring capacity must be in [1 , 2^62]");
+        }
+        std::size_t capacity{1};
+        while (capacity < n) capacity <<= 1;
+        return capacity;
+    }
+
+    T* item(std::size_t index) const noexcept {
+        return std::launder(reinterpret_cast<T*>(m_slots[index & m_mask].storage));
+    }
+
+    const std::size_t m_mask;
+    Slot* const m_slots;
+    alignas(64) std::atomic<std::size_t> m_tail{0}; //producer line
+    std::size_t m_cachedHead{0};
+    alignas(64) std::atomic<std::size_t> m_head{0}; //consumer line
+    std::size_t m_cachedTail{0}; //alignas(64) also pads the end --> nothing else lands on the consumer line
+};
+
+/*
+blocking_spsc_ring<T> : spsc_ring + push / pop / push_n / pop_n that wait instead of failing
+-try , spin (multi-core only) , then park on atomic::wait
+-one flag per side (there is only one thread per side) :
+    consumer : m_consumerParked = true ; fence ; ticket = m_pushEvents ; try again ; m_pushEvents.wait(ticket)
+    producer : publish ; fence ; if m_consumerParked.exchange(false) --> ++m_pushEvents , notify_one
+    the flag is cleared by the waker --> a burst of pushes wakes the consumer once
+-costs one fence per push (per batch with push_n) that the plain ring does not pay
+*/
+template <typename T>
+class blocking_spsc_ring {
+public:
+    explicit blocking_spsc_ring(std::size_t capacity) : m_ring{capacity} {}
+
+    std::size_t capacity() const noexcept { return m_ring.capacity(); }
+    std::size_t size_approx() const noexcept { return m_ring.size_approx(); }
+
+    template <typename U>
+    bool try_push(U&& value) {
+        if (!m_ring.try_push(std::forward<U>(value))) return false;
+        wake(m_consumerParked, m_pushEvents);
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        if (!m_ring.try_pop(out)) return false;
+        wake(m_producerParked, m_popEvents);
+        return true;
+    }
+
+    template <typename U>
+    void push(U&& value) {
+        blockUntil([&] { return try_push(std::forward<U>(value)); }, m_producerParked, m_popEvents);
+    }
+
+    void pop(T& out) {
+        blockUntil([&] { return try_pop(out); }, m_consumerParked, m_pushEvents);
+    }
+
+    T pop() {
+        T out;
+        pop(out);
+        return out;
+    }
+
+    //pushes all count items , waits for room as often as needed
+    template <typename ForwardIt>
+    void push_n(ForwardIt first, std::size_t count) {
+        while (count != 0) {
+            std::size_t pushed{0};
+            blockUntil([&] { return (pushed = m_ring.push_n(first, count)) != 0; }, m_producerParked, m_popEvents);
+            wake(m_consumerParked, m_pushEvents);
+            std::advance(first, pushed);
+            count -= pushed;
+        }
+    }
+
+    //waits for at least one item , then takes everything available up to maxCount
+    //maxCount 0 : returns 0 at once (there is nothing to wait for)
+    template <typename OutputIt>
+    std::size_t pop_n(OutputIt out, std::size_t maxCount) {
+        if (maxCount == 0) return 0;
+        std::size_t popped{0};
+        blockUntil([&] { return (popped = m_ring.pop_n(out, maxCount)) != 0; }, m_consumerParked, m_pushEvents);
+        wake(m_producerParked, m_popEvents);
+        return popped;
+    }
+
+private:
+    template <typename Attempt>
+    static void blockUntil(Attempt attempt, std::atomic<bool>& parked, std::atomic<std::uint32_t>& events) {
+        for (int i = 0; i < spsc_detail::SpinRounds && ring_detail::spinningHelps(); ++i) {
+            if (attempt()) return;
+            ring_detail::cpuRelax();
+        }
+        for (;;) {
+            parked.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::uint32_t ticket{events.load(std::memory_order_acquire)};
+            if (attempt()) {
+                parked.store(false, std::memory_order_relaxed);
+                return;
+            }
+            events.wait(ticket, std::memory_order_acquire);
+        }
+    }
+
+    static void wake(std::atomic<bool>& parked, std::atomic<std::uint32_t>& events) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_relaxed) && parked.exchange(false, std::memory_order_relaxed)) {
+            events.fetch_add(1, std::memory_order_release);
+            events.notify_one();
+        }
+    }
+
+    spsc_ring<T> m_ring;
+    alignas(64) std::atomic<bool> m_consumerParked{false}; //written by the producer too , keep it off the ring lines
+    std::atomic<std::uint32_t> m_pushEvents{0};
+    alignas(64) std::atomic<bool> m_producerParked{false};
+    std::atomic<std::uint32_t> m_popEvents{0};
+};
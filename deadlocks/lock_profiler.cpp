@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "lock_profiler.h"
+
+//g++ -std=c++20 -O2 -pthread lock_profiler.cpp -o lock_profiler
+
+//the kitchen : which lock is the hotspot ? guessing says "the log" , it is printed most often
+std::mutex orders;  //long hold : the whole order is prepared under it
+std::mutex pantry;  //taken together with orders , in both orders of the readme --> std::lock + adopt_lock
+std::mutex logbook; //very often , very short
+std::mutex stats;   //rarely , try_to_lock : skipped when busy
+
+int ordersDone = 0, ingredients = 0, logLines = 0, statsUpdates = 0;
+
+void spinFor(std::chrono::microseconds d) {
+    const auto end = std::chrono::steady_clock::now() + d;
+    while (std::chrono::steady_clock::now() < end) {
+    }
+}
+
+void chief(int chiefNumber, int dishes) {
+    for (int i = 0; i < dishes; ++i) {
+        {
+            profiled_lock_guard<std::mutex> lock(orders);
+            spinFor(std::chrono::microseconds(20));
+            ++ordersDone;
+        }
+        if (chiefNumber % 2 == 0) {
+            std::lock(orders, pantry); //the deadlock-free pair of readme.md
+            profiled_lock_guard<std::mutex> lock1(orders, std::adopt_lock);
+            profiled_lock_guard<std::mutex> lock2(pantry, std::adopt_lock);
+            ++ingredients;
+        } else {
+            profiled_lock_guard<std::mutex> lock1(pantry, std::defer_lock);
+            profiled_lock_guard<std::mutex> lock2(orders, std::defer_lock);
+            std::lock(lock1, lock2); //the guards themselves are lockable
+            ++ingredients;
+        }
+        for (int line = 0; line < 5; ++line) {
+            profiled_lock_guard<std::mutex> lock(logbook);
+            ++logLines;
+        }
+        try {
+            profiled_lock_guard<std::mutex> lock(stats, std::try_to_lock);
+            ++statsUpdates;
+        } catch (const std::runtime_error&) {
+            //busy : the next dish updates the stats
+        }
+    }
+}
+
+//ns per lock + unlock of one uncontended mutex
+template <typename Guard>
+double nanosPerLock(std::mutex& m) {
+    constexpr int rounds = 5'000'000;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        Guard lock(m);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+int main() {
+    LockProfiler::name(&orders, "orders");
+    LockProfiler::name(&pantry, "pantry");
+    LockProfiler::name(&logbook, "logbook");
+    LockProfiler::enable(true);
+
+    constexpr int chiefs = 4, dishes = 2000;
+    std::vector<std::thread> team;
+    for (int c = 0; c < chiefs; ++c) team.emplace_back(chief, c, dishes);
+    for (auto& t : team) t.join(); //the chiefs' tables are folded into the totals when they exit
+
+    std::cout << chiefs << " chiefs x " << dishes << " dishes : orders " << ordersDone << " , ingredients "
+              << ingredients << " , log lines " << logLines << " , stats " << statsUpdates << "\n\n";
+    LockProfiler::report(std::cout, 5); //stats is unnamed : shown by address
+
+    std::mutex m;
+    const double plain = nanosPerLock<std::lock_guard<std::mutex>>(m);
+    LockProfiler::enable(false);
+    const double disabled = nanosPerLock<profiled_lock_guard<std::mutex>>(m);
+    LockProfiler::enable(true);
+    const double enabled = nanosPerLock<profiled_lock_guard<std::mutex>>(m);
+    std::cout << "\nuncontended lock + unlock (ns) : std::lock_guard " << plain << " , profiled disabled " << disabled
+              << " , profiled enabled " << enabled << "\n";
+    return 0;
+}
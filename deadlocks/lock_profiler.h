@@ -0,0 +1,404 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+profiled_lock_guard<Mutex> : the lock_guard of readme.md (adopt_lock , defer_lock , try_to_lock) that also
+measures , per mutex , how often it is taken and how long threads wait for it and hold it
+-opt-in at run time : LockProfiler::enable(true) , while disabled a guard costs ONE relaxed load more than
+    the readme's lock_guard , no clock read , no thread-local access
+-per mutex (by address , or by a name given with LockProfiler::name(&mtx , "orders")) :
+    acquisitions , contended (the first try_lock failed , or try_to_lock failed) ,
+    wait time histogram (an uncontended acquisition waits 0) , hold time histogram , log2 buckets of nanoseconds
+-an acquisition is recorded when the guard releases it : a release right after a failed try_lock of the same
+    thread is a BACK-OFF (std::lock(guard1 , guard2) took one , could not get the other , gave the first back) ,
+    counted apart , its wait adds to the wait total , no acquisition and no hold sample
+-recording : every thread writes into its OWN table (thread_local , single writer , relaxed atomics) , no lock and
+    no shared cache line on the hot path , the report reads the tables of all live threads ,
+    a thread that exits folds its table into the global totals
+-LockProfiler::report(out , top) : the hottest locks first , hottest = most total time spent waiting for it
+-limits : TableSize mutexes per thread in the fixed table , the rest go to a map of the same thread
+    (its lock is taken only to add a mutex , and by the reporter) ,
+    a destroyed mutex whose address is reused adds up with the old one ,
+    a guard released right after an unrelated failed try_lock of its thread counts as a back-off
+*/
+
+class LockProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::size_t HistogramBuckets{32}; //bucket b : duration < 2^b ns , the last one : the rest
+    static constexpr std::size_t TableSize{64};        //distinct mutexes per thread before the overflow map
+
+    struct LockReport {
+        const void* mutex{nullptr};
+        std::string name;
+        std::uint64_t acquisitions{0};
+        std::uint64_t contended{0};
+        std::uint64_t backoffs{0}; //taken , then given back by std::lock before the caller got every lock
+        std::uint64_t waitTotalNanos{0};
+        std::uint64_t holdTotalNanos{0};
+        std::array<std::uint64_t, HistogramBuckets> waitHistogram{};
+        std::array<std::uint64_t, HistogramBuckets> holdHistogram{};
+
+        //upper bound of the bucket that holds the given fraction of the samples , 0 without samples
+        static std::uint64_t percentileNanos(const std::array<std::uint64_t, HistogramBuckets>& histogram,
+                                             double fraction) {
+            std::uint64_t samples{0};
+            for (const std::uint64_t n : histogram) samples += n;
+            if (samples == 0) return 0;
+            const auto rank{static_cast<std::uint64_t>(fraction * static_cast<double>(samples) + 0.5)};
+            std::uint64_t seen{0};
+            for (std::size_t b = 0; b < HistogramBuckets; ++b) {
+                seen += histogram[b];
+                if (seen >= std::max<std::uint64_t>(rank, 1)) return std::uint64_t{1} << b;
+            }
+            return std::uint64_t{1} << (HistogramBuckets - 1);
+        }
+    };
+
+    static void enable(bool on) noexcept { enabledFlag().store(on, std::memory_order_relaxed); }
+
+    static bool enabled() noexcept { return enabledFlag().load(std::memory_order_relaxed); }
+
+    //the report shows the name instead of the address
+    static void name(const void* mutex, std::string name) {
+        Registry& r{registry()};
+        std::lock_guard<std::mutex> lock(r.mtx);
+        r.names[mutex] = std::move(name);
+    }
+
+    //every mutex seen so far , live threads and exited ones together , hottest first
+    static std::vector<LockReport> snapshot() {
+        Registry& r{registry()};
+        std::lock_guard<std::mutex> lock(r.mtx); //keeps the live tables alive while they are read
+        std::map<const void*, LockReport> merged{r.retired};
+        for (const ThreadTable* table : r.live) table->addTo(merged);
+        std::vector<LockReport> reports;
+        reports.reserve(merged.size());
+        for (auto& [mutex, report] : merged) {
+            report.mutex = mutex;
+            const auto named{r.names.find(mutex)};
+            if (named != r.names.end()) {
+                report.name = named->second;
+            } else {
+                std::ostringstream address;
+                address << mutex;
+                report.name = address.str();
+            }
+            reports.push_back(std::move(report));
+        }
+        std::sort(reports.begin(), reports.end(), [](const LockReport& a, const LockReport& b) {
+            return a.waitTotalNanos != b.waitTotalNanos ? a.waitTotalNanos > b.waitTotalNanos
+                                                        : a.acquisitions > b.acquisitions;
+        });
+        return reports;
+    }
+
+    static void report(std::ostream& out, std::size_t top = 10) {
+        const std::vector<LockReport> reports{snapshot()};
+        const std::ios::fmtflags flags{out.flags()};
+        const std::streamsize precision{out.precision()};
+        out << std::fixed << std::setprecision(1);
+        out << "lock\t\tacquired\tcontended\tbacked off\twait total (ms)\twait p50 / p99 (us)\t"
+               "hold p50 / p99 (us)\n";
+        for (std::size_t i = 0; i < reports.size() && i < top; ++i) {
+            const LockReport& r{reports[i]};
+            const double contendedPercent{r.acquisitions == 0 ? 0.0 : 100.0 * r.contended / r.acquisitions};
+            out << std::left << std::setw(16) << r.name << std::right << r.acquisitions << "\t\t" << contendedPercent
+                << " %\t\t" << r.backoffs << "\t\t" << r.waitTotalNanos / 1e6 << "\t\t"
+                << micros(LockReport::percentileNanos(r.waitHistogram, 0.5)) << " / "
+                << micros(LockReport::percentileNanos(r.waitHistogram, 0.99)) << "\t\t"
+                << micros(LockReport::percentileNanos(r.holdHistogram, 0.5)) << " / "
+                << micros(LockReport::percentileNanos(r.holdHistogram, 0.99)) << "\n";
+        }
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    //forgets the samples of exited threads , live tables keep theirs
+    static void resetRetired() {
+        Registry& r{registry()};
+        std::lock_guard<std::mutex> lock(r.mtx);
+        r.retired.clear();
+    }
+
+    //used by profiled_lock_guard : the thread got a lock (by lock() or a successful try_lock)
+    static void noteAcquired() { threadTable().lastWasFailedTry = false; }
+
+    //the release of an acquisition , with its wait (0 when the first try_lock succeeded) :
+    //right after a failed try_lock of this thread it was a back-off , not a completed acquisition
+    static void recordRelease(const void* mutex, bool contended, std::uint64_t waitNanos, std::uint64_t holdNanos) {
+        ThreadTable& table{threadTable()};
+        Entry& e{table.find(mutex)};
+        bump(e.waitTotal, waitNanos);
+        if (std::exchange(table.lastWasFailedTry, false)) {
+            bump(e.backoffs, 1);
+            return;
+        }
+        bump(e.acquisitions, 1);
+        if (contended) bump(e.contended, 1);
+        bump(e.waitHistogram[bucketOf(waitNanos)], 1);
+        bump(e.holdTotal, holdNanos);
+        bump(e.holdHistogram[bucketOf(holdNanos)], 1);
+    }
+
+    //adopt_lock : locked elsewhere , nothing known about the wait
+    static void recordAdoption(const void* mutex) {
+        update(mutex, [](Entry& e) { bump(e.acquisitions, 1); });
+    }
+
+    //try_to_lock / try_lock that found the mutex taken
+    static void recordFailedTry(const void* mutex) {
+        ThreadTable& table{threadTable()};
+        bump(table.find(mutex).contended, 1);
+        table.lastWasFailedTry = true;
+    }
+
+    //adopt_lock guards : the hold time only
+    static void recordHold(const void* mutex, std::uint64_t holdNanos) {
+        update(mutex, [&](Entry& e) {
+            bump(e.holdTotal, holdNanos);
+            bump(e.holdHistogram[bucketOf(holdNanos)], 1);
+        });
+    }
+
+    static std::uint64_t nanosSince(Clock::time_point start) noexcept {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+
+private:
+    static double micros(std::uint64_t nanos) { return nanos / 1e3; }
+
+    template <typename Fn>
+    static void update(const void* mutex, Fn fn) {
+        fn(threadTable().find(mutex));
+    }
+
+    static std::size_t bucketOf(std::uint64_t nanos) noexcept {
+        std::size_t bucket{0};
+        while (bucket + 1 < HistogramBuckets && (std::uint64_t{1} << bucket) <= nanos) ++bucket;
+        return bucket;
+    }
+
+    //written by one thread only : load + store instead of an RMW , the reporter reads relaxed
+    static void bump(std::atomic<std::uint64_t>& counter, std::uint64_t by) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    struct Entry {
+        std::atomic<const void*> mutex{nullptr}; //published last , with release
+        std::atomic<std::uint64_t> acquisitions{0};
+        std::atomic<std::uint64_t> contended{0};
+        std::atomic<std::uint64_t> backoffs{0};
+        std::atomic<std::uint64_t> waitTotal{0};
+        std::atomic<std::uint64_t> holdTotal{0};
+        std::array<std::atomic<std::uint64_t>, HistogramBuckets> waitHistogram{};
+        std::array<std::atomic<std::uint64_t>, HistogramBuckets> holdHistogram{};
+
+        void addTo(LockReport& report) const noexcept {
+            report.acquisitions += acquisitions.load(std::memory_order_relaxed);
+            report.contended += contended.load(std::memory_order_relaxed);
+            report.backoffs += backoffs.load(std::memory_order_relaxed);
+            report.waitTotalNanos += waitTotal.load(std::memory_order_relaxed);
+            report.holdTotalNanos += holdTotal.load(std::memory_order_relaxed);
+            for (std::size_t b = 0; b < HistogramBuckets; ++b) {
+                report.waitHistogram[b] += waitHistogram[b].load(std::memory_order_relaxed);
+                report.holdHistogram[b] += holdHistogram[b].load(std::memory_order_relaxed);
+            }
+        }
+    };
+
+    //open addressing on the mutex address , never rehashed , full --> the overflow map of the same thread
+    struct ThreadTable {
+        std::array<Entry, TableSize> entries;
+        std::map<const void*, Entry> overflow; //only this thread inserts , under overflowMtx
+        mutable std::mutex overflowMtx;        //insertions vs the reporter's iteration , lookups need none
+        bool lastWasFailedTry{false};          //this thread only
+
+        Entry& find(const void* mutex) {
+            if (Entry* entry{findInTable(mutex)}) return *entry;
+            const auto found{overflow.find(mutex)}; //read-only , the reporter only reads too
+            if (found != overflow.end()) return found->second;
+            std::lock_guard<std::mutex> lock(overflowMtx);
+            return overflow[mutex];
+        }
+
+        Entry* findInTable(const void* mutex) noexcept {
+            const std::size_t start{(reinterpret_cast<std::uintptr_t>(mutex) >> 4) * 0x9E3779B97F4A7C15ull %
+                                    TableSize};
+            for (std::size_t i = 0; i < TableSize; ++i) {
+                Entry& entry{entries[(start + i) % TableSize]};
+                const void* key{entry.mutex.load(std::memory_order_relaxed)}; //only this thread writes keys
+                if (key == mutex) return &entry;
+                if (key == nullptr) {
+                    entry.mutex.store(mutex, std::memory_order_release);
+                    return &entry;
+                }
+            }
+            return nullptr;
+        }
+
+        void addTo(std::map<const void*, LockReport>& merged) const {
+            for (const Entry& entry : entries) {
+                const void* key{entry.mutex.load(std::memory_order_acquire)};
+                if (key != nullptr) entry.addTo(merged[key]);
+            }
+            std::lock_guard<std::mutex> lock(overflowMtx);
+            for (const auto& [mutex, entry] : overflow) entry.addTo(merged[mutex]);
+        }
+    };
+
+    struct Registry {
+        std::mutex mtx;
+        std::vector<const ThreadTable*> live;
+        std::map<const void*, LockReport> retired; //tables of exited threads , folded in
+        std::map<const void*, std::string> names;
+    };
+
+    //registers the thread's table at its first record , folds it into retired when the thread exits
+    struct TableOwner {
+        ThreadTable* table{new ThreadTable};
+
+        TableOwner() {
+            Registry& r{registry()};
+            std::lock_guard<std::mutex> lock(r.mtx);
+            r.live.push_back(table);
+        }
+
+        ~TableOwner() {
+            Registry& r{registry()};
+            std::lock_guard<std::mutex> lock(r.mtx);
+            table->addTo(r.retired);
+            r.live.erase(std::find(r.live.begin(), r.live.end(), table));
+            delete table;
+        }
+    };
+
+    static std::atomic<bool>& enabledFlag() noexcept {
+        static std::atomic<bool> flag{false};
+        return flag;
+    }
+
+    //never destroyed : threads that exit during static destruction still find it
+    static Registry& registry() {
+        static Registry* r{new Registry};
+        return *r;
+    }
+
+    static ThreadTable& threadTable() {
+        thread_local TableOwner owner;
+        return *owner.table;
+    }
+};
+
+template <typename mutex_type>
+class profiled_lock_guard {
+public:
+    //locks the mutex : a try_lock first , when it fails the acquisition counts as contended and the wait is timed
+    //recorded at the release , a back-off of std::lock is told apart there
+    explicit profiled_lock_guard(mutex_type& m) : mutex_(m), owns_lock_(false) { lock(); }
+
+    //mutex is already locked : counted , the hold time starts now , no wait sample
+    profiled_lock_guard(mutex_type& m, std::adopt_lock_t) : mutex_(m), owns_lock_(true) {
+        if (LockProfiler::enabled()) {
+            LockProfiler::recordAdoption(&mutex_);
+            adopted_ = true;
+            profiled_ = true;
+            acquired_ = LockProfiler::Clock::now();
+        }
+    }
+
+    //don't lock now : lock() / try_lock() later , or std::lock(guard1 , guard2)
+    profiled_lock_guard(mutex_type& m, std::defer_lock_t) noexcept : mutex_(m), owns_lock_(false) {}
+
+    //non-blocking , throws like the readme's lock_guard , a failed try counts as contended
+    profiled_lock_guard(mutex_type& m, std::try_to_lock_t) : mutex_(m), owns_lock_(false) {
+        if (!try_lock()) {
+            throw std::runtime_error("Failed to acquire mutex with try_to_lock");
+        }
+    }
+
+    profiled_lock_guard(const profiled_lock_guard&) = delete;
+    profiled_lock_guard& operator=(const profiled_lock_guard&) = delete;
+
+    ~profiled_lock_guard() noexcept {
+        if (owns_lock_) unlock();
+    }
+
+    void lock() {
+        if (!LockProfiler::enabled()) {
+            mutex_.lock();
+            owns_lock_ = true;
+            return;
+        }
+        if (mutex_.try_lock()) {
+            owns_lock_ = true;
+            startHold(false, 0);
+        } else {
+            const LockProfiler::Clock::time_point start{LockProfiler::Clock::now()};
+            mutex_.lock();
+            owns_lock_ = true;
+            startHold(true, LockProfiler::nanosSince(start));
+        }
+    }
+
+    bool try_lock() {
+        owns_lock_ = mutex_.try_lock();
+        if (LockProfiler::enabled()) {
+            if (owns_lock_) {
+                startHold(false, 0);
+            } else {
+                LockProfiler::recordFailedTry(&mutex_);
+            }
+        }
+        return owns_lock_;
+    }
+
+    void unlock() {
+        //read the clock BEFORE unlocking : a futex wake inside unlock() is not hold time
+        const std::uint64_t held{profiled_ ? LockProfiler::nanosSince(acquired_) : 0};
+        const bool timed{profiled_};
+        profiled_ = false;
+        owns_lock_ = false;
+        mutex_.unlock();
+        if (!timed) return;
+        if (adopted_) {
+            LockProfiler::recordHold(&mutex_, held);
+        } else {
+            LockProfiler::recordRelease(&mutex_, contended_, waitNanos_, held);
+        }
+    }
+
+    bool owns_lock() const noexcept { return owns_lock_; }
+
+private:
+    void startHold(bool contended, std::uint64_t waitNanos) {
+        LockProfiler::noteAcquired();
+        profiled_ = true;
+        contended_ = contended;
+        waitNanos_ = waitNanos;
+        acquired_ = LockProfiler::Clock::now();
+    }
+
+    mutex_type& mutex_;
+    bool owns_lock_;
+    bool profiled_{false}; //the acquisition is timed : recorded at the release
+    bool adopted_{false};  //adopt_lock : counted at once , only the hold time is left
+    bool contended_{false};
+    std::uint64_t waitNanos_{0};
+    LockProfiler::Clock::time_point acquired_{};
+};
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <latch>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "atomic_latch.h"
+
+//g++ -std=c++20 -O2 -pthread atomic_latch.cpp -o atomic_latch
+
+//the "Possible Implementation" from readme.md : mutex + condition_variable behind the counter
+class readme_latch {
+public:
+    explicit readme_latch(ptrdiff_t count) : counter_(count) {
+        if (count < 0) {
+            throw std::invalid_argument("latch count must be non-negative");
+        }
+    }
+
+    void count_down(ptrdiff_t n = 1) {
+        ptrdiff_t new_count = (counter_.fetch_sub(n, std::memory_order_acq_rel) - n);
+        if (new_count <= 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv_.notify_all();
+        }
+    }
+
+    bool try_wait() const noexcept {
+        return counter_.load(std::memory_order_acquire) == 0;
+    }
+
+    void wait() const {
+        if (try_wait()) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return try_wait(); });
+    }
+
+private:
+    std::atomic<ptrdiff_t> counter_;
+    mutable std::mutex mutex_;
+    mutable std::condition_variable cv_;
+};
+
+using Clock = std::chrono::steady_clock;
+
+std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+//fan-in : every thread counts down once at start-up , main waits for all of them
+//latency = main wakes up - the LAST count_down
+template <typename Latch>
+double fanInMicros(int threadCount) {
+    Latch ready(threadCount);
+    std::atomic<std::int64_t> lastArrival{0};
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&] {
+            const std::int64_t now{nowNs()};
+            for (std::int64_t seen = lastArrival.load(); seen < now && !lastArrival.compare_exchange_weak(seen, now);) {
+            }
+            ready.count_down();
+        });
+    }
+    ready.wait();
+    const std::int64_t woke{nowNs()};
+    for (auto& t : threads) t.join();
+    return (woke - lastArrival.load()) / 1000.0;
+}
+
+//fan-out : every thread waits on a start latch , main counts down once
+//latency = the LAST thread wakes up - count_down
+template <typename Latch>
+double fanOutMicros(int threadCount) {
+    Latch start(1);
+    atomic_latch parked(threadCount);
+    std::atomic<std::int64_t> lastWake{0};
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&] {
+            parked.count_down();
+            start.wait();
+            const std::int64_t now{nowNs()};
+            for (std::int64_t seen = lastWake.load(); seen < now && !lastWake.compare_exchange_weak(seen, now);) {
+            }
+        });
+    }
+    parked.wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); //let everybody fall asleep
+    const std::int64_t released{nowNs()};
+    start.count_down();
+    for (auto& t : threads) t.join();
+    return (lastWake.load() - released) / 1000.0;
+}
+
+template <typename Latch>
+void printRow(const char* name, int threadCount, int rounds) {
+    std::vector<double> fanIn, fanOut;
+    for (int r = 0; r < rounds; ++r) {
+        fanIn.push_back(fanInMicros<Latch>(threadCount));
+        fanOut.push_back(fanOutMicros<Latch>(threadCount));
+    }
+    std::sort(fanIn.begin(), fanIn.end());
+    std::sort(fanOut.begin(), fanOut.end());
+    std::cout << name << "\t" << sizeof(Latch) << "\t" << fanIn[rounds / 2] << "\t\t" << fanOut[rounds / 2] << "\n";
+}
+
+int main() {
+    //Example 1 of readme.md with atomic_latch
+    atomic_latch done(3);
+    std::vector<std::thread> workers;
+    for (int id = 1; id <= 3; ++id) {
+        workers.emplace_back([&done, id] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50 * id));
+            std::cout << "Worker " << id << " finished\n";
+            done.count_down();
+        });
+    }
+    std::cout << "try_wait before : " << std::boolalpha << done.try_wait() << "\n";
+    done.wait();
+    std::cout << "All workers finished , try_wait : " << done.try_wait() << "\n\n";
+    for (auto& w : workers) w.join();
+
+    constexpr int threadCount = 1000;
+    constexpr int rounds = 5;
+    std::cout << threadCount << " threads , median of " << rounds << " rounds , microseconds\n";
+    std::cout << "latch\t\tsizeof\tfan-in\t\tfan-out (last wake)\n";
+    printRow<readme_latch>("readme_latch", threadCount, rounds);
+    printRow<std::latch>("std::latch", threadCount, rounds);
+    printRow<atomic_latch>("atomic_latch", threadCount, rounds);
+    return 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/*
+atomic_latch : drop-in for std::latch / the "Possible Implementation" in readme.md
+built ONLY on C++20 atomic::wait / atomic::notify_all --> no mutex , no condition_variable
+-the whole state is one std::atomic<int32_t> : sizeof(atomic_latch) == 4
+    (32 bits is also the native futex word size on Linux : atomic<int32_t>::wait is a plain FUTEX_WAIT ,
+     no proxy word from the library's waiter table)
+-try_wait()   --> one acquire load
+-count_down() --> one fetch_sub (release) , notify_all() only by the call that reaches 0
+-wait()       --> atomic::wait(observed count) in a loop : the intermediate count_downs do not notify ,
+    the waiter simply keeps sleeping until the final one wakes everybody
+*/
+
+class atomic_latch {
+public:
+    static constexpr std::ptrdiff_t max() noexcept { return std::numeric_limits<std::int32_t>::max(); }
+
+    constexpr explicit atomic_latch(std::ptrdiff_t expected) : m_counter{static_cast<std::int32_t>(expected)} {
+        assert(expected >= 0 && expected <= max());
+    }
+
+    atomic_latch(const atomic_latch&) = delete;
+    atomic_latch& operator=(const atomic_latch&) = delete;
+
+    void count_down(std::ptrdiff_t n = 1) noexcept {
+        assert(n >= 0);
+        const std::int32_t previous{m_counter.fetch_sub(static_cast<std::int32_t>(n), std::memory_order_release)};
+        assert(previous >= n && "count_down below zero");
+        if (previous == n) {
+            m_counter.notify_all();
+        }
+    }
+
+    bool try_wait() const noexcept {
+        return m_counter.load(std::memory_order_acquire) == 0;
+    }
+
+    void wait() const noexcept {
+        for (std::int32_t current = m_counter.load(std::memory_order_acquire); current != 0;
+             current = m_counter.load(std::memory_order_acquire)) {
+            m_counter.wait(current, std::memory_order_acquire);
+        }
+    }
+
+    void arrive_and_wait(std::ptrdiff_t n = 1) noexcept {
+        //the thread that brings the count to 0 notifies and never waits
+        const std::int32_t previous{m_counter.fetch_sub(static_cast<std::int32_t>(n), std::memory_order_acq_rel)};
+        assert(previous >= n && "arrive_and_wait below zero");
+        if (previous == n) {
+            m_counter.notify_all();
+        } else {
+            wait();
+        }
+    }
+
+private:
+    std::atomic<std::int32_t> m_counter;
+};
+
+static_assert(sizeof(atomic_latch) == sizeof(std::int32_t));
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "readme_barrier.h"
+
+//g++ -std=c++20 -O3 -march=native -pthread heat_stencil.cpp -o heat_stencil
+
+/*
+2D heat diffusion , Jacobi iteration , row-partitioned across threads :
+    next[i][j] = 0.25 * (cur[i-1][j] + cur[i+1][j] + cur[i][j-1] + cur[i][j+1])
+-the top edge is held at 100 degrees , the other edges at 0
+-every worker updates its own block of rows , then arrive_and_wait()
+-the completion function (one thread , all others still waiting) swaps cur / next and
+    reduces the per-thread residuals --> converged when max |next - cur| < tolerance
+-4 FLOP per point (3 add + 1 mul) , the residual is not counted
+*/
+
+//sense-reversing spin barrier : no mutex , no sleep , waiters spin on one flag (and yield now and then)
+template <typename CompletionFunction>
+class spin_barrier {
+public:
+    spin_barrier(std::ptrdiff_t expected, CompletionFunction completion)
+        : m_expected{expected}, m_count{expected}, m_completion{std::move(completion)} {}
+
+    void arrive_and_wait() {
+        const bool sense{m_sense.load(std::memory_order_relaxed)};
+        if (m_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            m_completion();
+            m_count.store(m_expected, std::memory_order_relaxed);
+            m_sense.store(!sense, std::memory_order_release);
+            return;
+        }
+        for (int spins = 0; m_sense.load(std::memory_order_acquire) == sense; ++spins) {
+            if (spins % 64 == 63) std::this_thread::yield(); //the last arriver may share our core
+        }
+    }
+
+private:
+    const std::ptrdiff_t m_expected;
+    alignas(64) std::atomic<std::ptrdiff_t> m_count;
+    alignas(64) std::atomic<bool> m_sense{false};
+    CompletionFunction m_completion;
+};
+
+struct alignas(64) PaddedResidual {
+    double value{0};
+};
+
+struct HeatProblem {
+    HeatProblem(int size, int threads, double tol, int maxIter)
+        : n{size}, a(static_cast<std::size_t>(size) * size, 0.0), b(a), residual(threads),
+          tolerance{tol}, maxIterations{maxIter} {
+        for (int j = 0; j < n; ++j) a[j] = b[j] = 100.0; //hot top edge , kept in both buffers
+        current = a.data();
+        next = b.data();
+    }
+
+    int n;
+    std::vector<double> a, b;
+    double* current;
+    double* next;
+    std::vector<PaddedResidual> residual; //one cache line per thread
+    double tolerance;
+    int maxIterations;
+    int iterations{0};
+    double lastResidual{0};
+    bool done{false};
+};
+
+//rows [begin , end) of the interior
+void relaxRows(HeatProblem& p, int begin, int end, double& residual) {
+    const int n = p.n;
+    const double* cur = p.current;
+    double* nxt = p.next;
+    double maxDiff = 0;
+    for (int i = begin; i < end; ++i) {
+        const double* up = cur + (i - 1) * n;
+        const double* row = cur + i * n;
+        const double* down = cur + (i + 1) * n;
+        double* out = nxt + i * n;
+        for (int j = 1; j < n - 1; ++j) {
+            const double value = 0.25 * (up[j] + down[j] + row[j - 1] + row[j + 1]);
+            maxDiff = std::max(maxDiff, std::abs(value - row[j]));
+            out[j] = value;
+        }
+    }
+    residual = maxDiff;
+}
+
+//the worker(std::barrier<CompletionFunc>& , id) pattern of readme.md
+template <typename Barrier>
+void worker(Barrier& b, int id, int threadCount, HeatProblem& p) {
+    const int interior = p.n - 2;
+    const int begin = 1 + interior * id / threadCount;
+    const int end = 1 + interior * (id + 1) / threadCount;
+    while (!p.done) { //written only by the completion , read after the barrier
+        relaxRows(p, begin, end, p.residual[id].value);
+        b.arrive_and_wait();
+    }
+}
+
+struct Run {
+    double seconds;
+    int iterations;
+    double residual;
+};
+
+template <template <typename> class Barrier>
+Run solve(int size, int threadCount, double tolerance, int maxIterations) {
+    HeatProblem p(size, threadCount, tolerance, maxIterations);
+    auto onCompletion = [&p]() noexcept {
+        std::swap(p.current, p.next);
+        double maxDiff = 0;
+        for (const auto& r : p.residual) maxDiff = std::max(maxDiff, r.value);
+        p.lastResidual = maxDiff;
+        ++p.iterations;
+        p.done = maxDiff < p.tolerance || p.iterations >= p.maxIterations;
+    };
+    Barrier<decltype(onCompletion)> barrier(threadCount, onCompletion);
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::steady_clock::now();
+    for (int id = 0; id < threadCount; ++id) {
+        threads.emplace_back([&, id] { worker(barrier, id, threadCount, p); });
+    }
+    for (auto& t : threads) t.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return { seconds, p.iterations, p.lastResidual };
+}
+
+template <typename CF>
+using std_barrier = std::barrier<CF>;
+template <typename CF>
+using readme_barrier_t = readme_barrier; //std::function completion , the lambda converts
+
+double gflops(int size, const Run& run) {
+    return 4.0 * (size - 2) * (size - 2) * run.iterations / run.seconds / 1e9;
+}
+
+int main() {
+    //convergence : a small plate until max |change| < 1e-4
+    const auto converged = solve<std_barrier>(64, 4, 1e-4, 100'000);
+    std::cout << "64x64 plate , 4 threads : converged after " << converged.iterations << " iterations , residual "
+              << converged.residual << "\n\n";
+
+    //throughput : fixed number of iterations (tolerance 0 never converges)
+    constexpr int size = 1024;
+    constexpr int iterations = 200;
+    const int maxThreads = std::max(4u, std::thread::hardware_concurrency());
+    std::cout << size << "x" << size << " , " << iterations << " iterations , GFLOP/s (speed-up vs 1 thread)\n";
+    std::cout << "threads\tstd::barrier\treadme barrier\tspin barrier\n";
+    double base[3]{};
+    for (int threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+        const double results[3]{ gflops(size, solve<std_barrier>(size, threadCount, 0.0, iterations)),
+                                 gflops(size, solve<readme_barrier_t>(size, threadCount, 0.0, iterations)),
+                                 gflops(size, solve<spin_barrier>(size, threadCount, 0.0, iterations)) };
+        std::cout << threadCount;
+        for (int i = 0; i < 3; ++i) {
+            if (threadCount == 1) base[i] = results[i];
+            std::cout << "\t" << results[i] << " (" << results[i] / base[i] << "x)";
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
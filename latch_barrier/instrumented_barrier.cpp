@@ -0,0 +1,67 @@
+#include <barrier>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "instrumented_barrier.h"
+
+//g++ -std=c++20 -O2 -pthread instrumented_barrier.cpp -o instrumented_barrier
+
+//Example 1 of readme.md as an iterative job : worker 2 is slow in every third phase
+template <typename Barrier>
+void worker(Barrier& b, int id, int phases) {
+    b.labelThisThread(id);
+    for (int phase = 0; phase < phases; ++phase) {
+        const int micros = (id == 2 && phase % 3 == 0) ? 3000 : 500 + 100 * id;
+        std::this_thread::sleep_for(std::chrono::microseconds(micros)); // Simulate work
+        b.arrive_and_wait();
+    }
+}
+
+//pure phase latency : raw std::barrier , instrumented but disabled , instrumented and enabled
+template <typename Barrier>
+double phaseNanos(Barrier& barrier, int threadCount, int phases) {
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&] {
+            for (int phase = 0; phase < phases; ++phase) barrier.arrive_and_wait();
+        });
+    }
+    for (auto& t : threads) t.join();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / phases;
+}
+
+int main() {
+    int phaseCount = 0;
+    auto onCompletion = [&]() noexcept {
+        ++phaseCount;
+        std::this_thread::sleep_for(std::chrono::microseconds(50)); //e.g. a reduction
+    };
+    instrumented_barrier<decltype(onCompletion)> barrier(4, onCompletion);
+    barrier.reservePhases(30);
+    std::vector<std::thread> threads;
+    for (int id = 1; id <= 4; ++id) {
+        threads.emplace_back([&barrier, id] { worker(barrier, id, 30); });
+    }
+    for (auto& t : threads) t.join();
+
+    std::cout << phaseCount << " phases completed\n";
+    barrier.printSummary(std::cout);
+    std::ofstream trace("barrier_trace.json");
+    barrier.writeChromeTrace(trace);
+    std::cout << "trace written to barrier_trace.json (open in chrome://tracing or ui.perfetto.dev)\n\n";
+
+    constexpr int threadCount = 4;
+    constexpr int phases = 50'000;
+    std::barrier raw(threadCount);
+    instrumented_barrier<> disabled(threadCount, {}, false);
+    instrumented_barrier<> enabled(threadCount);
+    enabled.reservePhases(phases);
+    std::cout << "phase latency (ns) , " << threadCount << " threads\n";
+    std::cout << "std::barrier\t\t" << phaseNanos(raw, threadCount, phases) << "\n";
+    std::cout << "instrumented , off\t" << phaseNanos(disabled, threadCount, phases) << "\n";
+    std::cout << "instrumented , on\t" << phaseNanos(enabled, threadCount, phases) << "\n";
+    return 0;
+}
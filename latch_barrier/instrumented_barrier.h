@@ -0,0 +1,328 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "scalable_barrier.h"
+
+/*
+instrumented_barrier : wrapper around std::barrier (or any barrier of scalable_barrier.h) that answers
+"which worker slows every phase down ?"
+-per phase and thread : arrival and departure time --> wait time , work time between two phases
+-per phase : the last arriving thread (straggler) , arrival spread , completion-function duration
+-every thread writes ONLY its own buffer (a vector it alone appends to) : no lock , no shared cache line
+    the completion function writes the phase records , the barrier already serializes it
+-summary() / printSummary() / writeChromeTrace() read the buffers --> call them when the workers are
+    quiescent (joined , or all waiting somewhere else)
+-disabled (setEnabled(false)) : arrive_and_wait() is one branch + the wrapped barrier's own call
+thread ids in the reports : the label given with labelThisThread() , otherwise the order of the first arrival
+*/
+
+struct BarrierThreadStats {
+    int thread{};
+    std::uint64_t phases{};
+    std::uint64_t timesLast{};            //phases in which this thread arrived last
+    std::chrono::nanoseconds totalWait{};
+    std::chrono::nanoseconds maxWait{};
+    std::chrono::nanoseconds totalWork{}; //from leaving one phase to arriving at the next
+};
+
+struct BarrierPhaseStats {
+    std::uint32_t phase{};
+    int lastThread{-1};
+    std::chrono::nanoseconds arrivalSpread{}; //last arrival - first arrival
+    std::chrono::nanoseconds completion{};
+};
+
+struct BarrierSummary {
+    std::vector<BarrierThreadStats> threads;
+    std::vector<BarrierPhaseStats> phases;
+};
+
+template <typename CompletionFunction = barrier_detail::empty_completion,
+          template <typename> class Barrier = std::barrier>
+class instrumented_barrier {
+    struct TimedCompletion;
+    using Inner = Barrier<TimedCompletion>;
+
+public:
+    class arrival_token {
+        friend class instrumented_barrier;
+        arrival_token(typename Inner::arrival_token&& token, std::uint32_t phase, std::int64_t arrived)
+            : m_token{std::move(token)}, m_phase{phase}, m_arrived{arrived} {}
+        typename Inner::arrival_token m_token;
+        std::uint32_t m_phase;
+        std::int64_t m_arrived; //-1 : not recorded
+    };
+
+    static constexpr std::ptrdiff_t max() noexcept { return Inner::max(); }
+
+    explicit instrumented_barrier(std::ptrdiff_t expected, CompletionFunction completion = CompletionFunction{},
+                                  bool enabled = true)
+        : m_completion{std::move(completion)}, m_enabled{enabled},
+          m_buffers{std::make_unique<ThreadBuffer[]>(checkedCount(expected))},
+          m_bufferCount{static_cast<std::size_t>(expected)}, m_registry{static_cast<std::int32_t>(expected)}, m_barrier{expected, TimedCompletion{this}} {}
+
+    instrumented_barrier(const instrumented_barrier&) = delete;
+    instrumented_barrier& operator=(const instrumented_barrier&) = delete;
+
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    //avoids reallocation inside the measured phases
+    void reservePhases(std::size_t phases);
+    //the id of the calling thread in the reports , e.g. the worker id
+    void labelThisThread(int label) {
+        if (ThreadBuffer* buffer{threadBuffer()}) buffer->label = label;
+    }
+
+    void arrive_and_wait() {
+        if (!m_enabled.load(std::memory_order_relaxed)) {
+            m_barrier.arrive_and_wait();
+            return;
+        }
+        const std::uint32_t phase{m_phase.load(std::memory_order_relaxed)};
+        const std::int64_t arrived{now()};
+        m_barrier.arrive_and_wait();
+        record(phase, arrived, now());
+    }
+
+    [[nodiscard]] arrival_token arrive() {
+        if (!m_enabled.load(std::memory_order_relaxed)) {
+            return { m_barrier.arrive(), 0, -1 };
+        }
+        const std::uint32_t phase{m_phase.load(std::memory_order_relaxed)};
+        const std::int64_t arrived{now()};
+        return { m_barrier.arrive(), phase, arrived };
+    }
+
+    void wait(arrival_token&& token) {
+        m_barrier.wait(std::move(token.m_token));
+        if (token.m_arrived >= 0) {
+            record(token.m_phase, token.m_arrived, now());
+        }
+    }
+
+    void arrive_and_drop() {
+        if (m_enabled.load(std::memory_order_relaxed)) {
+            const std::int64_t arrived{now()};
+            record(m_phase.load(std::memory_order_relaxed), arrived, arrived);
+        }
+        m_barrier.arrive_and_drop();
+    }
+
+    BarrierSummary summary() const;
+    //the 5 threads that arrived last most often , then the slowest phases
+    void printSummary(std::ostream& os) const;
+    //chrome://tracing or https://ui.perfetto.dev : one row per thread with "work" and "wait" spans ,
+    //one row for the completion function
+    void writeChromeTrace(std::ostream& os) const;
+
+private:
+    struct Event {
+        std::uint32_t phase;
+        std::int64_t arrived; //ns since the barrier was built
+        std::int64_t departed;
+    };
+    struct alignas(64) ThreadBuffer {
+        std::vector<Event> events;
+        int label{-1};
+    };
+    struct PhaseRecord {
+        std::uint32_t phase;
+        std::int64_t begin;
+        std::int64_t end;
+    };
+
+    //runs inside the wrapped barrier , once per phase , never concurrently with itself
+    struct TimedCompletion {
+        instrumented_barrier* self;
+        void operator()() noexcept {
+            if (!self->m_enabled.load(std::memory_order_relaxed)) {
+                self->m_completion();
+            } else {
+                const std::int64_t begin{self->now()};
+                self->m_completion();
+                self->m_phaseRecords.push_back({ self->m_phase.load(std::memory_order_relaxed), begin, self->now() });
+            }
+            self->m_phase.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    static std::size_t checkedCount(std::ptrdiff_t expected) {
+        if (expected <= 0 || expected > max()) {
+            throw std::invalid_argument("barrier num_threads must be positive");
+        }
+        return static_cast<std::size_t>(expected);
+    }
+
+    std::int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_born).count();
+    }
+
+    //nullptr for more threads than expected : they are not recorded
+    ThreadBuffer* threadBuffer() {
+        const std::int32_t registration{m_registry.registration()};
+        return registration >= 0 ? &m_buffers[registration] : nullptr;
+    }
+
+    void record(std::uint32_t phase, std::int64_t arrived, std::int64_t departed) {
+        if (ThreadBuffer* buffer{threadBuffer()}) {
+            buffer->events.push_back({ phase, arrived, departed });
+        }
+    }
+
+    int labelOf(std::size_t registration) const {
+        return m_buffers[registration].label >= 0 ? m_buffers[registration].label : static_cast<int>(registration);
+    }
+
+    CompletionFunction m_completion;
+    std::atomic<bool> m_enabled;
+    std::atomic<std::uint32_t> m_phase{0}; //completed phases , read by every arrival , written by the completion
+    const std::chrono::steady_clock::time_point m_born{std::chrono::steady_clock::now()};
+    std::unique_ptr<ThreadBuffer[]> m_buffers;
+    const std::size_t m_bufferCount;
+    barrier_detail::thread_registry m_registry;
+    std::vector<PhaseRecord> m_phaseRecords;
+    Inner m_barrier;
+};
+
+template <typename CompletionFunction, template <typename> class Barrier>
+void instrumented_barrier<CompletionFunction, Barrier>::reservePhases(std::size_t phases) {
+    for (std::size_t i = 0; i < m_bufferCount; ++i) {
+        m_buffers[i].events.reserve(phases);
+    }
+    m_phaseRecords.reserve(phases);
+}
+
+template <typename CompletionFunction, template <typename> class Barrier>
+BarrierSummary instrumented_barrier<CompletionFunction, Barrier>::summary() const {
+    using std::chrono::nanoseconds;
+    BarrierSummary result;
+    const auto threadCount{static_cast<std::size_t>(m_registry.registered())};
+
+    struct Arrivals {
+        std::int64_t first{std::numeric_limits<std::int64_t>::max()};
+        std::int64_t last{std::numeric_limits<std::int64_t>::min()};
+        int lastThread{-1};
+    };
+    std::vector<Arrivals> arrivals;
+    for (std::size_t t = 0; t < threadCount; ++t) {
+        BarrierThreadStats stats;
+        stats.thread = labelOf(t);
+        const std::vector<Event>& events{m_buffers[t].events};
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            const Event& event{events[i]};
+            const nanoseconds wait{event.departed - event.arrived};
+            stats.totalWait += wait;
+            stats.maxWait = std::max(stats.maxWait, wait);
+            if (i > 0 && events[i - 1].phase + 1 == event.phase) {
+                stats.totalWork += nanoseconds{event.arrived - events[i - 1].departed};
+            }
+            if (event.phase >= arrivals.size()) arrivals.resize(event.phase + 1);
+            Arrivals& phase{arrivals[event.phase]};
+            phase.first = std::min(phase.first, event.arrived);
+            if (event.arrived > phase.last) {
+                phase.last = event.arrived;
+                phase.lastThread = static_cast<int>(t);
+            }
+        }
+        stats.phases = events.size();
+        result.threads.push_back(stats);
+    }
+
+    for (std::size_t p = 0; p < arrivals.size(); ++p) {
+        if (arrivals[p].lastThread < 0) continue;
+        BarrierPhaseStats stats;
+        stats.phase = static_cast<std::uint32_t>(p);
+        stats.lastThread = labelOf(static_cast<std::size_t>(arrivals[p].lastThread));
+        stats.arrivalSpread = nanoseconds{arrivals[p].last - arrivals[p].first};
+        ++result.threads[arrivals[p].lastThread].timesLast;
+        result.phases.push_back(stats);
+    }
+    for (const PhaseRecord& record : m_phaseRecords) {
+        auto it = std::lower_bound(result.phases.begin(), result.phases.end(), record.phase,
+                                   [](const BarrierPhaseStats& s, std::uint32_t phase) { return s.phase < phase; });
+        if (it != result.phases.end() && it->phase == record.phase) {
+            it->completion = nanoseconds{record.end - record.begin};
+        }
+    }
+    return result;
+}
+
+template <typename CompletionFunction, template <typename> class Barrier>
+void instrumented_barrier<CompletionFunction, Barrier>::printSummary(std::ostream& os) const {
+    const BarrierSummary s{summary()};
+    auto us = [](std::chrono::nanoseconds ns) { return ns.count() / 1000.0; };
+
+    std::vector<BarrierThreadStats> threads{s.threads};
+    std::sort(threads.begin(), threads.end(),
+              [](const auto& a, const auto& b) { return a.timesLast > b.timesLast; });
+    os << "phases : " << s.phases.size() << " , threads : " << s.threads.size() << "\n";
+    os << "thread\tlast in\twait total (us)\twait max (us)\twork total (us)\n";
+    for (std::size_t i = 0; i < std::min<std::size_t>(5, threads.size()); ++i) {
+        const auto& t{threads[i]};
+        os << t.thread << "\t" << t.timesLast << "/" << t.phases << "\t" << us(t.totalWait) << "\t\t"
+           << us(t.maxWait) << "\t\t" << us(t.totalWork) << "\n";
+    }
+
+    std::vector<BarrierPhaseStats> phases{s.phases};
+    std::sort(phases.begin(), phases.end(),
+              [](const auto& a, const auto& b) { return a.arrivalSpread > b.arrivalSpread; });
+    os << "phase\tlast thread\tarrival spread (us)\tcompletion (us)\n";
+    for (std::size_t i = 0; i < std::min<std::size_t>(5, phases.size()); ++i) {
+        const auto& p{phases[i]};
+        os << p.phase << "\t" << p.lastThread << "\t\t" << us(p.arrivalSpread) << "\t\t\t" << us(p.completion) << "\n";
+    }
+}
+
+template <typename CompletionFunction, template <typename> class Barrier>
+void instrumented_barrier<CompletionFunction, Barrier>::writeChromeTrace(std::ostream& os) const {
+    //Trace Event Format , "X" = complete event , timestamps in microseconds
+    //fixed with 3 decimals = exact ns (the default 6 significant digits round to 10 us after 1 s) ,
+    //the caller's format is restored at the end
+    const std::ios_base::fmtflags flags{os.flags()};
+    const std::streamsize precision{os.precision()};
+    os.setf(std::ios_base::fixed, std::ios_base::floatfield);
+    os.precision(3);
+    const auto threadCount{static_cast<std::size_t>(m_registry.registered())};
+    bool first{true};
+    auto span = [&](const char* name, std::size_t tid, std::int64_t begin, std::int64_t end, std::uint32_t phase) {
+        os << (first ? "\n" : ",\n") << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+           << ",\"ts\":" << begin / 1000.0 << ",\"dur\":" << (end - begin) / 1000.0
+           << ",\"args\":{\"phase\":" << phase << "}}";
+        first = false;
+    };
+    auto threadName = [&](std::size_t tid, const std::string& name) {
+        os << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+           << ",\"args\":{\"name\":\"" << name << "\"}}";
+        first = false;
+    };
+    os << "{\"traceEvents\":[";
+    for (std::size_t t = 0; t < threadCount; ++t) {
+        threadName(t, "thread " + std::to_string(labelOf(t)));
+        const std::vector<Event>& events{m_buffers[t].events};
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            if (i > 0 && events[i - 1].phase + 1 == events[i].phase) {
+                span("work", t, events[i - 1].departed, events[i].arrived, events[i].phase);
+            }
+            span("wait", t, events[i].arrived, events[i].departed, events[i].phase);
+        }
+    }
+    threadName(threadCount, "completion");
+    for (const PhaseRecord& record : m_phaseRecords) {
+        span("completion", threadCount, record.begin, record.end, record.phase);
+    }
+    os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    os.flags(flags);
+    os.precision(precision);
+}
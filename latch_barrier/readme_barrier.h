@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+
+//the "Possible Implementation" from readme.md : one count_ , one generation_ , one mutex for everybody
+class readme_barrier {
+public:
+    explicit readme_barrier(ptrdiff_t num_threads, std::function<void()> completion = nullptr)
+        : initial_count_(num_threads), count_(num_threads), generation_(0), completion_(completion) {
+        if (num_threads <= 0) {
+            throw std::invalid_argument("barrier num_threads must be positive");
+        }
+    }
+
+    void arrive_and_wait() {
+        auto old_gen = generation_.load(std::memory_order_acquire);
+        if (count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            count_.store(initial_count_, std::memory_order_relaxed);
+            generation_.fetch_add(1, std::memory_order_release);
+            if (completion_) {
+                completion_();
+            }
+            cv_.notify_all();
+        } else {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this, old_gen] {
+                return generation_.load(std::memory_order_acquire) != old_gen;
+            });
+        }
+    }
+
+private:
+    ptrdiff_t initial_count_;
+    std::atomic<ptrdiff_t> count_;
+    std::atomic<size_t> generation_;
+    std::function<void()> completion_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "readme_barrier.h"
+#include "scalable_barrier.h"
+
+//g++ -std=c++20 -O2 -pthread scalable_barrier.cpp -o scalable_barrier
+
+//every phase : the completion function must see all arrivals , and nobody may leave before it ran
+//with drops : the odd threads leave with arrive_and_drop() in the middle , the others go on
+template <template <typename> class Barrier>
+bool check(int threadCount, int phases, bool withDrops) {
+    std::atomic<int> arrived{0};
+    std::atomic<int> droppedNow{0};
+    int expected = threadCount;
+    int completions = 0;
+    bool ok = true;
+    auto onCompletion = [&]() noexcept {
+        ok = ok && arrived.load() == expected;
+        arrived.store(0);
+        expected -= droppedNow.exchange(0);
+        ++completions;
+    };
+    Barrier<decltype(onCompletion)> barrier(threadCount, onCompletion);
+    std::atomic<bool> early{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            for (int phase = 0; phase < phases; ++phase) {
+                if (withDrops && t % 2 == 1 && phase == phases / 2) {
+                    droppedNow.fetch_add(1);
+                    arrived.fetch_add(1);
+                    barrier.arrive_and_drop();
+                    return;
+                }
+                arrived.fetch_add(1);
+                if (phase % 3 == 0) {
+                    barrier.wait(barrier.arrive()); //split arrive / wait
+                } else {
+                    barrier.arrive_and_wait();
+                }
+                if (completions != phase + 1) early = true; //released before the completion ran
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    return ok && !early && completions == phases;
+}
+
+//the same drops with the default (empty) completion : the dissemination barrier then has no
+//central step in the phases without drops , the test must simply finish
+template <typename Barrier>
+bool dropsWithoutCompletion(int threadCount, int phases) {
+    Barrier barrier(threadCount);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            for (int phase = 0; phase < phases; ++phase) {
+                if (t % 3 == 1 && phase == phases / 2) {
+                    barrier.arrive_and_drop();
+                    return;
+                }
+                barrier.arrive_and_wait();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    return true;
+}
+
+//arrive_and_wait in a loop , no work --> pure phase latency
+template <typename Barrier>
+double phaseNanos(int threadCount, int phases) {
+    Barrier barrier(threadCount);
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&] {
+            for (int phase = 0; phase < phases; ++phase) {
+                barrier.arrive_and_wait();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / phases;
+}
+
+template <typename CF>
+using std_barrier = std::barrier<CF>;
+
+int main() {
+    std::cout << std::boolalpha << "correctness (completion sees every arrival , runs before the release , drops)\n";
+    for (int threadCount : { 1, 3, 8, 13, 32 }) {
+        for (bool withDrops : { false, true }) {
+            std::cout << threadCount << "\tthreads" << (withDrops ? " + drops : " : "         : ")
+                      << "std " << check<std_barrier>(threadCount, 100, withDrops)
+                      << " , tree " << check<combining_tree_barrier>(threadCount, 100, withDrops)
+                      << " , tournament " << check<tournament_barrier>(threadCount, 100, withDrops)
+                      << " , dissemination " << check<dissemination_barrier>(threadCount, 100, withDrops) << "\n";
+        }
+    }
+
+    std::cout << "drops without completion : " << dropsWithoutCompletion<combining_tree_barrier<>>(32, 1000)
+              << " " << dropsWithoutCompletion<tournament_barrier<>>(32, 1000)
+              << " " << dropsWithoutCompletion<dissemination_barrier<>>(32, 1000) << "\n";
+
+    std::cout << "\nphase latency (ns) , arrive_and_wait in a loop\n";
+    std::cout << "threads\treadme\tstd::barrier\ttree\ttournament\tdissemination\n";
+    for (int threadCount : { 1, 2, 4, 8, 16, 32, 64 }) {
+        const int phases = std::max(500, 200'000 / threadCount);
+        std::cout << threadCount << "\t" << phaseNanos<readme_barrier>(threadCount, phases) << "\t"
+                  << phaseNanos<std::barrier<>>(threadCount, phases) << "\t\t"
+                  << phaseNanos<combining_tree_barrier<>>(threadCount, phases) << "\t"
+                  << phaseNanos<tournament_barrier<>>(threadCount, phases) << "\t\t"
+                  << phaseNanos<dissemination_barrier<>>(threadCount, phases) << "\n";
+    }
+    return 0;
+}
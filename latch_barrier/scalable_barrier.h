@@ -0,0 +1,450 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+Scalable barriers for high core counts , same API as std::barrier / the "Possible Implementation" in readme.md :
+arrive() , wait(token) , arrive_and_wait() , arrive_and_drop() , completion function , max()
+
+the readme barrier puts every thread on ONE count_ + generation_ pair (plus a mutex) :
+with 64+ threads every phase is a queue of RMWs on the same cache line.
+here the ARRIVAL is spread over many cache lines , each touched by a few threads only :
+-combining_tree_barrier : counters in a radix-4 tree , the last arriver at a node climbs to its parent ,
+    the last one at the root completes the phase --> at most 4 threads per cache line
+-tournament_barrier     : static bracket , in round r the "loser" slot (bit r set) sets a flag of its
+    "winner" and leaves , the winner waits for it and plays the next round , slot 0 is the champion
+    --> no RMW at all on the arrival path , only stores and loads of single-writer flags
+-dissemination_barrier  : ceil(log2 N) rounds , in round r slot i signals slot (i + 2^r) % N and waits
+    for its own flag --> after the last round every thread knows that everybody arrived ,
+    nobody has to wake anybody
+the RELEASE is one phase word (m_phase) that every waiter reads (read-shared , written once per phase) :
+spin briefly (only on multi-core machines) , then atomic::wait / notify_all
+
+participants : a thread is registered on its first arrival and keeps its slot (the same threads must
+arrive in every phase , as with the readme barrier). arrive_and_drop() takes effect at the end of the
+phase : the completing thread packs the remaining slots again.
+
+blocking : combining_tree_barrier::arrive() never blocks (like std::barrier).
+in the tournament a winner must wait for its losers inside arrive() , in the dissemination barrier
+arrive() does all the rounds --> there arrive() returns only when the phase is (nearly) done.
+*/
+
+namespace barrier_detail {
+    struct empty_completion {
+        void operator()() noexcept {}
+    };
+
+    inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    //on a single core a spinning waiter only delays the thread it waits for
+    inline bool spinningHelps() {
+        static const bool multiCore{std::thread::hardware_concurrency() > 1};
+        return multiCore;
+    }
+
+    inline constexpr int SpinRounds{256};
+
+    //spin a little , then sleep in atomic::wait until `word` != old
+    inline void waitWhileEqual(const std::atomic<std::uint32_t>& word, std::uint32_t old) {
+        for (int i = 0; spinningHelps() && i < SpinRounds; ++i) {
+            if (word.load(std::memory_order_acquire) != old) return;
+            cpuRelax();
+        }
+        while (word.load(std::memory_order_acquire) == old) {
+            word.wait(old, std::memory_order_acquire);
+        }
+    }
+
+    //flags only grow , compared modulo 2^32
+    inline bool reached(std::uint32_t value, std::uint32_t target) {
+        return static_cast<std::int32_t>(value - target) >= 0;
+    }
+
+    inline void waitUntilReached(const std::atomic<std::uint32_t>& word, std::uint32_t target) {
+        for (int i = 0; spinningHelps() && i < SpinRounds; ++i) {
+            if (reached(word.load(std::memory_order_acquire), target)) return;
+            cpuRelax();
+        }
+        for (std::uint32_t value = word.load(std::memory_order_acquire); !reached(value, target);
+             value = word.load(std::memory_order_acquire)) {
+            word.wait(value, std::memory_order_acquire);
+        }
+    }
+
+    inline void signal(std::atomic<std::uint32_t>& word, std::uint32_t value) {
+        word.store(value, std::memory_order_release);
+        word.notify_one();
+    }
+
+    //signal() for a flag with more than one writer : a late , smaller value must not overwrite a newer one
+    inline void raise(std::atomic<std::uint32_t>& word, std::uint32_t value) {
+        for (std::uint32_t current = word.load(std::memory_order_relaxed);
+             !reached(current, value) &&
+             !word.compare_exchange_weak(current, value, std::memory_order_release, std::memory_order_relaxed);) {
+        }
+        word.notify_one();
+    }
+
+    //a number per thread , given out on its first arrival at any barrier , never reused (std::thread::id is)
+    inline std::uint64_t threadSerial() {
+        static std::atomic<std::uint64_t> next{0};
+        thread_local const std::uint64_t serial{++next};
+        return serial;
+    }
+
+    //the registration of every thread in ONE barrier , owned by the barrier : open addressing on threadSerial() ,
+    //an entry is written once , on the first arrival of its thread , and read lock-free afterwards
+    //(no thread_local list that grows with every barrier a thread used , nothing left behind by a dead barrier)
+    class thread_registry {
+    public:
+        explicit thread_registry(std::int32_t capacity) : m_capacity{capacity} {
+            std::size_t entries{2};
+            for (m_shift = 63; entries < 2 * static_cast<std::size_t>(capacity); entries <<= 1) --m_shift;
+            m_mask = entries - 1;
+            m_entries = std::make_unique<Entry[]>(entries);
+        }
+
+        //in [0 , capacity) , given out on the first call of a thread , -1 for threads beyond capacity
+        std::int32_t registration() {
+            const std::uint64_t me{threadSerial()};
+            std::size_t i{home(me)};
+            for (;; i = (i + 1) & m_mask) {
+                const std::uint64_t owner{m_entries[i].thread.load(std::memory_order_acquire)};
+                if (owner == me) return m_entries[i].index;
+                if (owner == 0) break; //not registered yet
+            }
+            if (m_registered.load(std::memory_order_relaxed) >= m_capacity) return -1;
+            const std::int32_t next{m_registered.fetch_add(1, std::memory_order_relaxed)};
+            if (next >= m_capacity) return -1;
+            //at most capacity entries in a table of 2 * capacity or more : an empty entry is always ahead
+            for (;; i = (i + 1) & m_mask) {
+                std::uint64_t empty{0};
+                if (m_entries[i].thread.compare_exchange_strong(empty, me, std::memory_order_acq_rel)) {
+                    m_entries[i].index = next; //read only by this thread
+                    return next;
+                }
+            }
+        }
+
+        //threads registered so far
+        std::int32_t registered() const {
+            return std::min(m_registered.load(std::memory_order_relaxed), m_capacity);
+        }
+
+    private:
+        struct Entry {
+            std::atomic<std::uint64_t> thread{0}; //threadSerial() , 0 : free
+            std::int32_t index{-1};
+        };
+
+        //the high bits of a multiplicative hash
+        std::size_t home(std::uint64_t serial) const {
+            return static_cast<std::size_t>((serial * 0x9E3779B97F4A7C15ull) >> m_shift);
+        }
+
+        const std::int32_t m_capacity;
+        int m_shift{};
+        std::size_t m_mask{};
+        std::unique_ptr<Entry[]> m_entries;
+        std::atomic<std::int32_t> m_registered{0};
+    };
+
+    //the part every barrier shares : phase word , completion , registration , drops
+    template <typename CompletionFunction>
+    class phase_core {
+    public:
+        static constexpr std::ptrdiff_t MaxParticipants{1 << 16};
+
+        phase_core(std::ptrdiff_t expected, CompletionFunction completion)
+            : m_expected{checkedExpected(expected)}, m_registry{m_expected}, m_completion{std::move(completion)} {
+            m_slotOf.resize(m_expected);
+            m_dropped.resize(m_expected);
+            for (std::int32_t r = 0; r < m_expected; ++r) m_slotOf[r] = r;
+        }
+
+        //live participants in the current phase
+        std::int32_t expected() const { return m_expected; }
+        std::uint32_t phase() const { return m_phase.load(std::memory_order_acquire); }
+        void waitForPhaseEnd(std::uint32_t phase) const { waitWhileEqual(m_phase, phase); }
+
+        //registers the calling thread on its first arrival
+        std::int32_t registration() {
+            const std::int32_t registration{m_registry.registration()};
+            if (registration < 0) {
+                throw std::logic_error("more threads arrive than the barrier expects");
+            }
+            return registration;
+        }
+        std::int32_t slot() { return m_slotOf[registration()]; }
+
+        //before the arrival that drops : the completing thread sees it through the arrival chain
+        void markDropped(std::int32_t registration, unsigned parity) {
+            m_dropped[registration] = 1;
+            m_pendingDrops[parity].fetch_add(1, std::memory_order_relaxed);
+        }
+        bool dropsPending(unsigned parity) const { return m_pendingDrops[parity].load(std::memory_order_relaxed) != 0; }
+
+        //called by exactly one thread once everybody arrived : completion , drops , release
+        template <typename Rebuild>
+        void completePhase(std::uint32_t phase, unsigned parity, Rebuild&& rebuild) {
+            m_completion();
+            if (dropsPending(parity)) {
+                m_pendingDrops[parity].store(0, std::memory_order_relaxed);
+                std::int32_t next{0};
+                for (std::size_t r = 0; r < m_slotOf.size(); ++r) {
+                    m_slotOf[r] = m_dropped[r] ? -1 : next++;
+                }
+                m_expected = next;
+                rebuild(next);
+            }
+            m_phase.store(phase + 1, std::memory_order_release);
+            m_phase.notify_all();
+        }
+
+    private:
+        static std::int32_t checkedExpected(std::ptrdiff_t expected) {
+            if (expected <= 0 || expected > MaxParticipants) {
+                throw std::invalid_argument("barrier num_threads must be positive");
+            }
+            return static_cast<std::int32_t>(expected);
+        }
+
+        alignas(64) std::atomic<std::uint32_t> m_phase{0};
+        alignas(64) std::int32_t m_expected{};
+        thread_registry m_registry;
+        std::vector<std::int32_t> m_slotOf;  //registration --> slot , written only at the end of a phase
+        std::vector<std::uint8_t> m_dropped; //written by the dropping thread itself
+        std::atomic<std::int32_t> m_pendingDrops[2]{};
+        CompletionFunction m_completion;
+    };
+}
+
+template <typename CompletionFunction = barrier_detail::empty_completion>
+class combining_tree_barrier {
+public:
+    class arrival_token {
+        friend class combining_tree_barrier;
+        explicit arrival_token(std::uint32_t phase) : m_phase{phase} {}
+        std::uint32_t m_phase;
+    };
+
+    static constexpr std::ptrdiff_t max() noexcept { return Core::MaxParticipants; }
+
+    explicit combining_tree_barrier(std::ptrdiff_t expected, CompletionFunction completion = CompletionFunction{})
+        : m_core{expected, std::move(completion)}, m_nodes{std::make_unique<Node[]>(nodeCount(expected))} {
+        build(m_core.expected());
+    }
+
+    combining_tree_barrier(const combining_tree_barrier&) = delete;
+    combining_tree_barrier& operator=(const combining_tree_barrier&) = delete;
+
+    [[nodiscard]] arrival_token arrive() {
+        const std::uint32_t phase{m_core.phase()}; //cannot end before this arrival
+        arriveAt(m_core.slot() / Radix, phase);
+        return arrival_token{phase};
+    }
+    void wait(arrival_token&& token) const { m_core.waitForPhaseEnd(token.m_phase); }
+    void arrive_and_wait() { wait(arrive()); }
+    void arrive_and_drop() {
+        const std::uint32_t phase{m_core.phase()};
+        const std::int32_t registration{m_core.registration()};
+        const std::int32_t slot{m_core.slot()};
+        m_core.markDropped(registration, 0);
+        arriveAt(slot / Radix, phase);
+    }
+
+private:
+    using Core = barrier_detail::phase_core<CompletionFunction>;
+    static constexpr std::int32_t Radix{4};
+
+    struct alignas(64) Node {
+        std::atomic<std::int32_t> remaining{0};
+        std::int32_t expected{0};
+        std::int32_t parent{-1};
+    };
+
+    static std::size_t nodeCount(std::ptrdiff_t participants) {
+        std::size_t count{0};
+        for (std::ptrdiff_t level = participants; ; level = (level + Radix - 1) / Radix) {
+            const std::ptrdiff_t nodes{(level + Radix - 1) / Radix};
+            count += static_cast<std::size_t>(nodes);
+            if (nodes <= 1) return count;
+        }
+    }
+
+    //leaves first (slot / Radix) , then every level above , the root is the last node
+    //called in the constructor and at the end of a phase with drops (nobody is inside arriveAt then)
+    void build(std::int32_t participants) {
+        std::int32_t levelBegin{0};
+        for (std::int32_t children = participants; ; ) {
+            const std::int32_t nodes{(children + Radix - 1) / Radix};
+            for (std::int32_t i = 0; i < nodes; ++i) {
+                Node& node{m_nodes[levelBegin + i]};
+                node.expected = std::min(Radix, children - i * Radix);
+                node.remaining.store(node.expected, std::memory_order_relaxed);
+                node.parent = nodes > 1 ? levelBegin + nodes + i / Radix : -1;
+            }
+            if (nodes <= 1) return;
+            levelBegin += nodes;
+            children = nodes;
+        }
+    }
+
+    void arriveAt(std::int32_t index, std::uint32_t phase) {
+        for (;;) {
+            Node& node{m_nodes[index]};
+            if (node.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                return; //not the last one here , somebody else climbs
+            }
+            node.remaining.store(node.expected, std::memory_order_relaxed); //ready for the next phase
+            if (node.parent < 0) {
+                m_core.completePhase(phase, 0, [this](std::int32_t participants) { build(participants); });
+                return;
+            }
+            index = node.parent;
+        }
+    }
+
+    Core m_core;
+    std::unique_ptr<Node[]> m_nodes;
+};
+
+template <typename CompletionFunction = barrier_detail::empty_completion>
+class tournament_barrier {
+public:
+    class arrival_token {
+        friend class tournament_barrier;
+        explicit arrival_token(std::uint32_t phase) : m_phase{phase} {}
+        std::uint32_t m_phase;
+    };
+
+    static constexpr std::ptrdiff_t max() noexcept { return Core::MaxParticipants; }
+
+    explicit tournament_barrier(std::ptrdiff_t expected, CompletionFunction completion = CompletionFunction{})
+        : m_core{expected, std::move(completion)}, m_slots{std::make_unique<Slot[]>(m_core.expected())} {}
+
+    tournament_barrier(const tournament_barrier&) = delete;
+    tournament_barrier& operator=(const tournament_barrier&) = delete;
+
+    //a loser leaves after one store , a winner waits here for its losers
+    [[nodiscard]] arrival_token arrive() {
+        const std::uint32_t phase{m_core.phase()};
+        play(m_core.slot(), phase);
+        return arrival_token{phase};
+    }
+    void wait(arrival_token&& token) const { m_core.waitForPhaseEnd(token.m_phase); }
+    void arrive_and_wait() { wait(arrive()); }
+    void arrive_and_drop() {
+        const std::uint32_t phase{m_core.phase()};
+        const std::int32_t registration{m_core.registration()};
+        const std::int32_t slot{m_core.slot()};
+        m_core.markDropped(registration, 0);
+        play(slot, phase);
+    }
+
+private:
+    using Core = barrier_detail::phase_core<CompletionFunction>;
+
+    //flag r : set by the loser of round r to phase + 1 (single writer , only grows)
+    struct alignas(64) Slot {
+        std::atomic<std::uint32_t> fromLoser[16]{};
+    };
+
+    //the bracket follows from slot and expected() alone , a drop needs no rebuild
+    void play(std::int32_t slot, std::uint32_t phase) {
+        const std::int32_t participants{m_core.expected()};
+        for (std::int32_t round = 0; (1 << round) < participants; ++round) {
+            if (slot & (1 << round)) {
+                barrier_detail::signal(m_slots[slot - (1 << round)].fromLoser[round], phase + 1);
+                return;
+            }
+            if (slot + (1 << round) < participants) {
+                barrier_detail::waitUntilReached(m_slots[slot].fromLoser[round], phase + 1);
+            }
+        }
+        m_core.completePhase(phase, 0, [](std::int32_t) {}); //slot 0 , the champion
+    }
+
+    Core m_core;
+    std::unique_ptr<Slot[]> m_slots;
+};
+
+template <typename CompletionFunction = barrier_detail::empty_completion>
+class dissemination_barrier {
+public:
+    class arrival_token {
+        friend class dissemination_barrier;
+        arrival_token() = default;
+    };
+
+    static constexpr std::ptrdiff_t max() noexcept { return Core::MaxParticipants; }
+
+    explicit dissemination_barrier(std::ptrdiff_t expected, CompletionFunction completion = CompletionFunction{})
+        : m_core{expected, std::move(completion)}, m_slots{std::make_unique<Slot[]>(m_core.expected())} {}
+
+    dissemination_barrier(const dissemination_barrier&) = delete;
+    dissemination_barrier& operator=(const dissemination_barrier&) = delete;
+
+    //all the rounds happen here : when arrive() returns the phase is over
+    [[nodiscard]] arrival_token arrive() {
+        disseminate(false);
+        return arrival_token{};
+    }
+    void wait(arrival_token&&) const {}
+    void arrive_and_wait() { disseminate(false); }
+    void arrive_and_drop() { disseminate(true); }
+
+private:
+    using Core = barrier_detail::phase_core<CompletionFunction>;
+    static constexpr bool HasCompletion{!std::is_same_v<CompletionFunction, barrier_detail::empty_completion>};
+
+    struct Slot {
+        alignas(64) std::atomic<std::uint32_t> flag[16]{}; //flag r : set by the partner of round r
+        alignas(64) std::uint32_t episode{0};              //phases done , the same in every live slot
+    };
+
+    void disseminate(bool dropping) {
+        const std::uint32_t phase{m_core.phase()};
+        const std::int32_t registration{m_core.registration()};
+        const std::int32_t slot{m_core.slot()};
+        const std::int32_t participants{m_core.expected()};
+        Slot& me{m_slots[slot]};
+        const std::uint32_t episode{++me.episode};
+        //a thread is at most one episode ahead of the others --> two drop counters , by parity
+        const unsigned parity{episode & 1u};
+        if (dropping) {
+            m_core.markDropped(registration, parity);
+        }
+        for (std::int32_t round = 0, distance = 1; distance < participants; ++round, distance <<= 1) {
+            //after drops re-packed the slots , a slow thread of the previous phase may still signal
+            //into a slot that has a new owner --> raise , never overwrite
+            barrier_detail::raise(m_slots[(slot + distance) % participants].flag[round], episode);
+            barrier_detail::waitUntilReached(me.flag[round], episode);
+        }
+        //everybody arrived. a completion function or a drop needs ONE thread while the others wait
+        if (HasCompletion || m_core.dropsPending(parity)) {
+            if (slot == 0) {
+                m_core.completePhase(phase, parity, [](std::int32_t) {});
+            } else if (!dropping) {
+                m_core.waitForPhaseEnd(phase);
+            }
+        }
+    }
+
+    Core m_core;
+    std::unique_ptr<Slot[]> m_slots;
+};
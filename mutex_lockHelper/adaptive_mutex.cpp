@@ -0,0 +1,81 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "adaptive_mutex.h"
+
+//g++ -std=c++20 -O2 -pthread adaptive_mutex.cpp -o adaptive_mutex
+
+//readme.md , with the mutex type and the length of the critical section as knobs
+template <typename Mutex>
+class Counter {
+    int value = 0;
+    Mutex mtx;
+
+public:
+    void increment(int n, int work) {
+        for (int i = 0; i < n; ++i) {
+            std::lock_guard<Mutex> lock(mtx);
+            value++;
+            volatile int burn = 0; //the rest of the critical section
+            for (int w = 0; w < work; ++w) burn = burn + w;
+        }
+    }
+    int get_value() const { return value; }
+    const Mutex& mutex() const { return mtx; }
+};
+
+template <typename Mutex>
+double millionLocksPerSecond(int threads, int perThread, int work, Counter<Mutex>& c) {
+    std::vector<std::thread> team;
+    const auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) team.emplace_back(&Counter<Mutex>::increment, &c, perThread, work);
+    for (auto& t : team) t.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return threads * perThread / seconds / 1e6;
+}
+
+int main() {
+    //the other lock helpers of readme.md take it as they take std::mutex
+    {
+        adaptive_mutex m1, m2;
+        {
+            std::scoped_lock both(m1, m2);
+        }
+        std::unique_lock<adaptive_mutex> lock(m1, std::defer_lock);
+        std::condition_variable_any cv;
+        bool ready = false;
+        std::thread waiter([&] {
+            std::unique_lock<adaptive_mutex> l(m1);
+            cv.wait(l, [&] { return ready; });
+        });
+        lock.lock();
+        ready = true;
+        lock.unlock();
+        cv.notify_one();
+        waiter.join();
+        std::cout << "scoped_lock , unique_lock , condition_variable_any : ok , try_lock " << std::boolalpha
+                  << m2.try_lock() << "\n\n";
+        m2.unlock();
+    }
+
+    constexpr int threads = 4;
+    constexpr int perThread = 250'000;
+    std::cout << threads << " threads x " << perThread << " increments , hardware threads "
+              << std::thread::hardware_concurrency() << " , million locks / s\n";
+    std::cout << "critical section\tstd::mutex\tadaptive_mutex\tspin limit\tvalues exact\n";
+    for (int work : { 0, 10, 100, 1000, 10000 }) {
+        const int n = work >= 1000 ? perThread / 10 : perThread;
+        Counter<std::mutex> plain;
+        Counter<adaptive_mutex> adaptive;
+        const double p = millionLocksPerSecond(threads, n, work, plain);
+        const double a = millionLocksPerSecond(threads, n, work, adaptive);
+        std::cout << "value++ , " << work << " loops\t" << (work < 1000 ? "\t" : "") << p << "\t\t" << a << "\t\t"
+                  << adaptive.mutex().spin_limit() << "\t\t" << std::boolalpha
+                  << (plain.get_value() == threads * n && adaptive.get_value() == threads * n) << "\n";
+    }
+    return 0;
+}
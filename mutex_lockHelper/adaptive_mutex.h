@@ -0,0 +1,109 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include "lock_spin.h"
+
+/*
+adaptive_mutex : spin a little , then sleep on a futex (Linux only) , a drop-in for std::mutex (Lockable)
+-readme : Counter::increment locks a std::mutex around value++ , under contention the loser goes to sleep in the
+    kernel at once , and the sleep + wakeup cost far more than the critical section it waited for
+-here : the loser first spins (pause , reading the word only , no cache line ping-pong) , the owner is usually out
+    of a short critical section within a few hundred cycles
+-the spin is bounded and self-tuning , per mutex :
+    limit = 2 * estimate + MinSpins , at most MaxSpins
+    got the lock after i spins  --> estimate moves 1/8 of the way to i
+    spun the whole limit , no luck --> estimate shrinks by 1/8 : long critical sections end up with a short spin
+-on one core the owner cannot run while we spin --> no spin at all
+-the futex word (U. Drepper , "Futexes Are Tricky" , mutex #3) :
+    0 unlocked , 1 locked , 2 locked and maybe sleepers
+    unlock : exchange(0) , was 2 --> FUTEX_WAKE 1
+    a woken or parking thread always sets 2 : a sleeper is never left behind without a wake to come
+-std::lock_guard , std::unique_lock , std::scoped_lock , std::condition_variable_any work unchanged
+*/
+
+namespace adaptive_detail {
+    inline void futexWait(std::atomic<std::uint32_t>& word, std::uint32_t expected) {
+        static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+    }
+
+    inline void futexWake(std::atomic<std::uint32_t>& word, int count) {
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+    }
+}
+
+class adaptive_mutex {
+public:
+    static constexpr int MinSpins{16};
+    static constexpr int MaxSpins{4000};
+
+    adaptive_mutex() = default;
+    adaptive_mutex(const adaptive_mutex&) = delete;
+    adaptive_mutex& operator=(const adaptive_mutex&) = delete;
+
+    void lock() {
+        std::uint32_t expected{Unlocked};
+        if (m_state.compare_exchange_strong(expected, Locked, std::memory_order_acquire, std::memory_order_relaxed)) {
+            return;
+        }
+        lockContended();
+    }
+
+    bool try_lock() noexcept {
+        std::uint32_t expected{Unlocked};
+        return m_state.compare_exchange_strong(expected, Locked, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock() noexcept {
+        if (m_state.exchange(Unlocked, std::memory_order_release) == Contended) {
+            adaptive_detail::futexWake(m_state, 1);
+        }
+    }
+
+    //the current spin limit , for tuning and benchmarks
+    int spin_limit() const noexcept { return limitFor(m_spinEstimate.load(std::memory_order_relaxed)); }
+
+private:
+    enum : std::uint32_t { Unlocked = 0, Locked = 1, Contended = 2 };
+
+    static int limitFor(int estimate) noexcept { return std::min(MaxSpins, 2 * estimate + MinSpins); }
+
+    void lockContended() {
+        if (lock_detail::spinningHelps() && spin()) {
+            return;
+        }
+        //from here on we may sleep : announce it with 2 , whoever unlocks will wake one of us
+        while (m_state.exchange(Contended, std::memory_order_acquire) != Unlocked) {
+            adaptive_detail::futexWait(m_state, Contended);
+        }
+    }
+
+    //true when the lock was taken while spinning
+    bool spin() noexcept {
+        //racing updates of the estimate are harmless , it is only a hint
+        const int estimate{m_spinEstimate.load(std::memory_order_relaxed)};
+        const int limit{limitFor(estimate)};
+        for (int i = 0; i < limit; ++i) {
+            lock_detail::cpuRelax();
+            if (m_state.load(std::memory_order_relaxed) != Unlocked) {
+                continue; //read-only while it is held
+            }
+            std::uint32_t expected{Unlocked};
+            if (m_state.compare_exchange_weak(expected, Locked, std::memory_order_acquire,
+                                              std::memory_order_relaxed)) {
+                m_spinEstimate.store(estimate + (i - estimate) / 8, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        m_spinEstimate.store(std::max(0, estimate - estimate / 8 - 1), std::memory_order_relaxed);
+        return false;
+    }
+
+    std::atomic<std::uint32_t> m_state{Unlocked};
+    std::atomic<int> m_spinEstimate{MaxSpins / 8}; //a moderate start , it adapts within a few contended locks
+};
@@ -0,0 +1,145 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include "seqlock.h"
+
+//g++ -std=c++20 -O2 -pthread seqlock.cpp -o seqlock
+
+//a config snapshot : one cache line , every field derived from version --> a torn copy is detectable
+struct Config {
+    std::uint64_t version{0};
+    std::uint64_t limits[6]{};
+    std::uint64_t checksum{0};
+};
+
+Config makeConfig(std::uint64_t version) {
+    Config c;
+    c.version = version;
+    c.checksum = version;
+    for (int i = 0; i < 6; ++i) {
+        c.limits[i] = version * (i + 1);
+        c.checksum ^= c.limits[i];
+    }
+    return c;
+}
+
+bool consistent(const Config& c) {
+    std::uint64_t checksum = c.version;
+    for (int i = 0; i < 6; ++i) {
+        if (c.limits[i] != c.version * (i + 1)) return false;
+        checksum ^= c.limits[i];
+    }
+    return checksum == c.checksum;
+}
+
+//the readme's readers-writer option
+class SharedMutexConfig {
+public:
+    Config load() const {
+        std::shared_lock<std::shared_mutex> lock(m_mtx);
+        return m_config;
+    }
+
+    void store(const Config& config) {
+        std::unique_lock<std::shared_mutex> lock(m_mtx);
+        m_config = config;
+    }
+
+private:
+    mutable std::shared_mutex m_mtx;
+    Config m_config;
+};
+
+//torture : writers as fast as they can , readers check every copy
+void torture(int readers, std::chrono::milliseconds duration) {
+    SeqLock<Config> config(makeConfig(0));
+    std::atomic<bool> done{false};
+    std::atomic<std::uint64_t> reads{0}, failedAttempts{0}, torn{0}, backwards{0};
+    std::vector<std::thread> team;
+    for (int w = 0; w < 2; ++w) { //two writers : serialized by the writer lock
+        team.emplace_back([&] {
+            while (!done.load(std::memory_order_relaxed)) {
+                config.update([](Config& c) { c = makeConfig(c.version + 1); });
+            }
+        });
+    }
+    for (int r = 0; r < readers; ++r) {
+        team.emplace_back([&] {
+            std::uint64_t last = 0, n = 0, failed = 0, bad = 0, back = 0;
+            Config c;
+            while (!done.load(std::memory_order_relaxed)) {
+                if (!config.try_load(c)) {
+                    ++failed;
+                    continue;
+                }
+                ++n;
+                if (!consistent(c)) ++bad;
+                if (c.version < last) ++back;
+                last = c.version;
+            }
+            reads += n;
+            failedAttempts += failed;
+            torn += bad;
+            backwards += back;
+        });
+    }
+    std::this_thread::sleep_for(duration);
+    done = true;
+    for (auto& t : team) t.join();
+    const Config final = config.load();
+    std::cout << "torture : " << readers << " readers , 2 writers , writes " << final.version << " , reads " << reads
+              << " , retried attempts " << failedAttempts << " , torn copies " << torn << " , version went back "
+              << backwards << " , final consistent " << std::boolalpha << consistent(final) << "\n";
+}
+
+//readers as fast as they can , one writer publishes a new config every millisecond
+template <typename Shared>
+double millionReadsPerSecond(Shared& shared, int readers) {
+    constexpr auto duration = std::chrono::milliseconds(300);
+    std::atomic<bool> done{false};
+    std::atomic<std::uint64_t> reads{0}, torn{0};
+    std::vector<std::thread> team;
+    team.emplace_back([&] {
+        for (std::uint64_t version = 1; !done.load(std::memory_order_relaxed); ++version) {
+            shared.store(makeConfig(version));
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    for (int r = 0; r < readers; ++r) {
+        team.emplace_back([&] {
+            std::uint64_t n = 0, bad = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                if (!consistent(shared.load())) ++bad;
+                ++n;
+            }
+            reads += n;
+            torn += bad;
+        });
+    }
+    std::this_thread::sleep_for(duration);
+    done = true;
+    for (auto& t : team) t.join();
+    if (torn != 0) std::cout << "torn copies : " << torn << "\n";
+    return reads / std::chrono::duration<double>(duration).count() / 1e6;
+}
+
+int main() {
+    torture(4, std::chrono::seconds(1));
+
+    std::cout << "\nmillion reads / s , 1 writer every 1 ms , hardware threads "
+              << std::thread::hardware_concurrency() << "\n";
+    std::cout << "readers\tshared_mutex\tSeqLock\n";
+    for (int readers : { 1, 2, 4, 8, 16 }) {
+        SharedMutexConfig locked;
+        SeqLock<Config> sequenced;
+        const double l = millionReadsPerSecond(locked, readers);
+        const double s = millionReadsPerSecond(sequenced, readers);
+        std::cout << readers << "\t" << l << "\t\t" << s << "\n";
+    }
+    return 0;
+}
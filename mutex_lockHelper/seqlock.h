@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include "lock_spin.h"
+
+/*
+SeqLock<T> : read-mostly shared state , readers never write to shared memory
+-readme : std::shared_mutex , many readers or one writer --> but lock_shared() is an RMW on the lock word ,
+    every reader takes that cache line exclusively , readers on many cores fight each other with no writer around
+-here : a sequence number next to the data
+    writer : seq odd (write in progress) , write the data , seq even again , writers are serialized by a mutex
+    reader : seq (even , else retry) , copy the data , seq again , unchanged --> the copy is consistent
+    readers only LOAD : the lines stay shared in every reader's cache , reads scale with the cores
+-for small trivially copyable T (config , stats snapshots) : a reader copies all of T on every attempt ,
+    and retries while a write is in progress --> writes must be rare and short
+-the data lives in std::atomic<word>s accessed relaxed , a reader racing a writer is then no data race (UB) ,
+    only a torn copy that the second seq check throws away (H. Boehm , "Can seqlocks get along with
+    programming language memory models?")
+*/
+
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock<T> copies T word by word");
+    static_assert(std::is_default_constructible_v<T>);
+
+public:
+    static constexpr int SpinsBeforeYield{64}; //a writer preempted mid-write : give it the core
+
+    SeqLock() : SeqLock(T{}) {}
+
+    explicit SeqLock(const T& value) { storeWords(value); }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    //a consistent copy , retries while a write is in progress
+    T load() const noexcept {
+        T out;
+        for (int attempt = 1;; ++attempt) {
+            if (try_load(out)) return out;
+            if (attempt % SpinsBeforeYield == 0) {
+                std::this_thread::yield();
+            } else {
+                lock_detail::cpuRelax();
+            }
+        }
+    }
+
+    //one attempt : false when a write was in progress or came in between , out is then unspecified
+    bool try_load(T& out) const noexcept {
+        const std::uint64_t before{m_seq.load(std::memory_order_acquire)};
+        if (before & 1) return false;
+        Word words[WordCount];
+        for (std::size_t i = 0; i < WordCount; ++i) words[i] = m_words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire); //the data loads stay before the second seq load
+        if (m_seq.load(std::memory_order_relaxed) != before) return false;
+        std::memcpy(&out, words, sizeof(T));
+        return true;
+    }
+
+    void store(const T& value) {
+        std::lock_guard<std::mutex> lock(m_writer);
+        write(value);
+    }
+
+    //read-modify-write under the writer lock : fn(T&) edits a copy , readers see before or after , never half
+    template <typename Fn>
+    void update(Fn fn) {
+        std::lock_guard<std::mutex> lock(m_writer);
+        T value{readUnderWriterLock()};
+        fn(value);
+        write(value);
+    }
+
+    //even : number of writes * 2
+    std::uint64_t sequence() const noexcept { return m_seq.load(std::memory_order_acquire); }
+
+private:
+    using Word = std::uint64_t;
+    static constexpr std::size_t WordCount{(sizeof(T) + sizeof(Word) - 1) / sizeof(Word)};
+
+    void write(const T& value) {
+        const std::uint64_t seq{m_seq.load(std::memory_order_relaxed)};
+        m_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release); //the odd seq is visible before any new word
+        storeWords(value);
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    void storeWords(const T& value) {
+        Word words[WordCount]{};
+        std::memcpy(words, &value, sizeof(T));
+        for (std::size_t i = 0; i < WordCount; ++i) m_words[i].store(words[i], std::memory_order_relaxed);
+    }
+
+    //no writer can interleave , the words are stable
+    T readUnderWriterLock() const {
+        Word words[WordCount];
+        for (std::size_t i = 0; i < WordCount; ++i) words[i] = m_words[i].load(std::memory_order_relaxed);
+        T out;
+        std::memcpy(&out, words, sizeof(T));
+        return out;
+    }
+
+    alignas(64) std::atomic<std::uint64_t> m_seq{0};
+    std::atomic<Word> m_words[WordCount];
+    alignas(64) std::mutex m_writer; //on its own line : readers never touch it
+};
@@ -0,0 +1,86 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "sharded_counter.h"
+
+//g++ -std=c++20 -O2 -pthread sharded_counter.cpp -o sharded_counter
+
+constexpr std::uint64_t TotalIncrements = 8'000'000; //split between the threads
+
+//readme.md : the mutex fix
+int mutexCounter = 0;
+std::mutex mtx;
+
+//readme.md : the atomic fix
+std::atomic<int> atomicCounter(0);
+
+template <typename Increment>
+double millionIncrementsPerSecond(int threads, Increment increment) {
+    const std::uint64_t perThread = TotalIncrements / threads;
+    std::vector<std::thread> team;
+    const auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        team.emplace_back([&increment, perThread] {
+            for (std::uint64_t i = 0; i < perThread; ++i) increment();
+        });
+    }
+    for (auto& t : team) t.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return perThread * threads / seconds / 1e6;
+}
+
+int main() {
+    std::cout << TotalIncrements << " increments , hardware threads " << std::thread::hardware_concurrency()
+              << " , million increments / s\n";
+    std::cout << "threads\tmutex\tatomic<int>\tsharded/thread\tsharded/cpu\tall exact\n";
+    for (int threads : { 1, 2, 4, 8, 16, 32, 64 }) {
+        const std::uint64_t expected = TotalIncrements / threads * threads;
+        mutexCounter = 0;
+        atomicCounter = 0;
+        ShardedCounter perThread(ShardedCounter::Shards::PerThread);
+        ShardedCounter perCpu(ShardedCounter::Shards::PerCpu);
+        const double m = millionIncrementsPerSecond(threads, [] {
+            std::lock_guard<std::mutex> lock(mtx);
+            mutexCounter++;
+        });
+        const double a = millionIncrementsPerSecond(threads, [] { atomicCounter++; });
+        const double t = millionIncrementsPerSecond(threads, [&perThread] { perThread++; });
+        const double c = millionIncrementsPerSecond(threads, [&perCpu] { perCpu++; });
+        const bool exact = static_cast<std::uint64_t>(mutexCounter) == expected &&
+                           static_cast<std::uint64_t>(atomicCounter.load()) == expected &&
+                           perThread.read_exact() == expected && perCpu.read_exact() == expected;
+        std::cout << threads << "\t" << m << "\t" << a << "\t\t" << t << "\t\t" << c << "\t\t" << std::boolalpha
+                  << exact << "\n";
+    }
+
+    //a reader that polls the total while 8 threads increment : what each read mode costs both sides
+    std::cout << "\n8 writers + 1 reader polling the total\n";
+    std::cout << "read mode\twrites (M/s)\treads (k/s)\tsnapshots monotonic\n";
+    for (bool exactReads : { false, true }) {
+        ShardedCounter counter;
+        std::atomic<bool> done{false};
+        std::uint64_t reads = 0;
+        bool monotonic = true;
+        std::thread reader([&] {
+            std::uint64_t last = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                const std::uint64_t now = exactReads ? counter.read_exact() : counter.read_relaxed();
+                monotonic = monotonic && now >= last;
+                last = now;
+                ++reads;
+            }
+        });
+        const auto start = std::chrono::steady_clock::now();
+        const double writes = millionIncrementsPerSecond(8, [&counter] { counter++; });
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        done = true;
+        reader.join();
+        std::cout << (exactReads ? "exact" : "relaxed") << "\t\t" << writes << "\t\t" << reads / seconds / 1e3
+                  << "\t\t" << std::boolalpha << monotonic << "\n";
+    }
+    return 0;
+}
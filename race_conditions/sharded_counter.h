@@ -0,0 +1,128 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <sched.h>
+
+/*
+ShardedCounter : counter++ for many threads , without the one cache line every thread fights for
+-readme : std::mutex + counter++ or std::atomic<int> counter++ --> correct , but every increment of every thread
+    takes the SAME cache line exclusively , the line travels from core to core and the increments serialize
+-here : the counter is split into shards , one cache line each , a thread increments only its own shard
+    PerThread : shard = a small index given to the thread at its first increment (threads beyond shards() share)
+    PerCpu    : shard = the CPU the thread is running on (sched_getcpu) , a thread that migrates simply moves on
+    the shard is still updated with an atomic fetch_add (two threads can meet on one shard) ,
+    but the line stays in the cache of one core --> an uncontended atomic , no line transfer
+-reads sum the shards , O(shards) , reads should be rare compared to increments :
+    read_relaxed() : includes every increment that happened-before the read , concurrent ones maybe or maybe not ,
+                     the result need not be a value the counter ever had at one instant
+    read_exact()   : a snapshot , the sum the shards had at ONE instant during the call :
+                     collect twice , equal sums --> no shard moved in between (increments only , n > 0)
+                     still moving after a few rounds --> writers are parked until the snapshot is taken
+-increments only (unsigned) : this is what keeps the double collect sound
+*/
+
+namespace sharded_detail {
+    inline std::size_t roundUpToPowerOfTwo(std::size_t n) {
+        std::size_t shards{1};
+        while (shards < n) shards <<= 1;
+        return shards;
+    }
+
+    //0 , 1 , 2 ... in the order the threads first increment ANY counter
+    inline std::size_t threadIndex() {
+        static std::atomic<std::size_t> next{0};
+        thread_local const std::size_t index{next.fetch_add(1, std::memory_order_relaxed)};
+        return index;
+    }
+}
+
+class ShardedCounter {
+public:
+    enum class Shards { PerThread, PerCpu };
+
+    static constexpr int OptimisticRounds{4}; //double collects before read_exact parks the writers
+
+    //shardCount 0 : the number of hardware threads , at least 16 , rounded up to a power of two
+    explicit ShardedCounter(Shards policy = Shards::PerThread, std::size_t shardCount = 0)
+        : m_policy{policy},
+          m_mask{sharded_detail::roundUpToPowerOfTwo(shardCount != 0 ? shardCount : defaultShards()) - 1},
+          m_shards{std::make_unique<Shard[]>(m_mask + 1)} {}
+
+    ShardedCounter(const ShardedCounter&) = delete;
+    ShardedCounter& operator=(const ShardedCounter&) = delete;
+
+    void add(std::uint64_t n = 1) noexcept {
+        if (n == 0) return;
+        if (m_freezers.load(std::memory_order_acquire) != 0) waitWhileFrozen();
+        m_shards[shardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    //counter++ of readme.md compiles unchanged
+    ShardedCounter& operator++() noexcept {
+        add(1);
+        return *this;
+    }
+
+    void operator++(int) noexcept { add(1); }
+
+    std::uint64_t read_relaxed() const noexcept { return collect(); }
+
+    std::uint64_t read_exact() const {
+        std::uint64_t before{collect()};
+        for (int round = 0; round < OptimisticRounds; ++round) {
+            const std::uint64_t after{collect()};
+            if (after == before) return after;
+            before = after;
+        }
+        //the writers keep moving : park them , only the increments already past the check can still land
+        m_freezers.fetch_add(1, std::memory_order_seq_cst);
+        std::uint64_t after{collect()};
+        do {
+            before = after;
+            after = collect();
+        } while (after != before);
+        if (m_freezers.fetch_sub(1, std::memory_order_release) == 1) m_freezers.notify_all();
+        return after;
+    }
+
+    std::size_t shards() const noexcept { return m_mask + 1; }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> value{0};
+    };
+
+    static std::size_t defaultShards() {
+        const std::size_t hardware{std::thread::hardware_concurrency()};
+        return hardware > 16 ? hardware : 16;
+    }
+
+    std::size_t shardIndex() const noexcept {
+        if (m_policy == Shards::PerCpu) {
+            const int cpu{sched_getcpu()}; //vDSO / rseq : a few ns , no system call
+            if (cpu >= 0) return static_cast<std::size_t>(cpu) & m_mask;
+        }
+        return sharded_detail::threadIndex() & m_mask;
+    }
+
+    std::uint64_t collect() const noexcept {
+        std::uint64_t sum{0};
+        for (std::size_t i = 0; i <= m_mask; ++i) sum += m_shards[i].value.load(std::memory_order_acquire);
+        return sum;
+    }
+
+    void waitWhileFrozen() const noexcept {
+        for (std::uint32_t freezers{m_freezers.load(std::memory_order_acquire)}; freezers != 0;
+             freezers = m_freezers.load(std::memory_order_acquire)) {
+            m_freezers.wait(freezers, std::memory_order_acquire);
+        }
+    }
+
+    const Shards m_policy;
+    const std::size_t m_mask;
+    const std::unique_ptr<Shard[]> m_shards;
+    alignas(64) mutable std::atomic<std::uint32_t> m_freezers{0}; //read by every add , written only by read_exact
+};
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "fair_semaphore.h"
+#include "futex_semaphore.h"
+
+//g++ -std=c++20 -O2 -pthread fair_semaphore.cpp -o fair_semaphore
+
+struct Percentiles {
+    double p50, p99, p999, max; //microseconds
+};
+
+Percentiles percentiles(std::vector<std::int64_t>& samples) {
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double q) {
+        return samples[std::min(samples.size() - 1, static_cast<std::size_t>(q * samples.size()))] / 1000.0;
+    };
+    return { at(0.50), at(0.99), at(0.999), samples.back() / 1000.0 };
+}
+
+//every thread : acquire 1..maxBatch permits , a little work , release them
+//the time spent in acquire is recorded for every call
+template <typename Semaphore>
+Percentiles acquireLatency(int threadCount, int permits, int maxBatch, int iterations) {
+    Semaphore sem(permits);
+    std::atomic<bool> go{false};
+    std::vector<std::vector<std::int64_t>> samples(threadCount);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            samples[t].reserve(iterations);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            volatile int work = 0;
+            for (int i = 0; i < iterations; ++i) {
+                const int batch = 1 + (i + t) % maxBatch;
+                const auto start = std::chrono::steady_clock::now();
+                sem.acquire(batch);
+                samples[t].push_back((std::chrono::steady_clock::now() - start).count());
+                for (int w = 0; w < 200; ++w) work = work + w;
+                sem.release(batch);
+            }
+        });
+    }
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+
+    std::vector<std::int64_t> all;
+    for (auto& s : samples) all.insert(all.end(), s.begin(), s.end());
+    return percentiles(all);
+}
+
+template <typename Semaphore>
+void printRow(const char* name, int threadCount, int maxBatch) {
+    const auto p = acquireLatency<Semaphore>(threadCount, 4, maxBatch, 20'000);
+    std::cout << name << "\t" << threadCount << "\t" << maxBatch << "\t"
+              << p.p50 << "\t" << p.p99 << "\t" << p.p999 << "\t" << p.max << "\n";
+}
+
+int main() {
+    //batched acquire : a job that needs 3 of the 4 connections takes them all at once
+    fair_counting_semaphore<4> connections(4);
+    connections.acquire(3);
+    std::cout << "try_acquire(2) with 1 left   : " << (connections.try_acquire(2) ? "acquired" : "refused") << "\n";
+    std::cout << "try_acquire_for(2 , 20ms)    : "
+              << (connections.try_acquire_for(2, std::chrono::milliseconds(20)) ? "acquired" : "timed out") << "\n";
+
+    //FIFO : the queued request for 2 permits is served before a later request for 1
+    std::vector<int> order;
+    std::mutex orderMutex;
+    std::thread big([&] {
+        connections.acquire(2);
+        std::lock_guard lock{orderMutex};
+        order.push_back(2);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::thread small([&] {
+        connections.acquire(1); //1 permit is free , but the request for 2 came first
+        std::lock_guard lock{orderMutex};
+        order.push_back(1);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    connections.release(1); //2 free --> the head (big) is granted , small keeps waiting
+    big.join();
+    connections.release(2);
+    small.join();
+    std::cout << "served in order              : " << order[0] << " permits , then " << order[1] << " permit\n\n";
+
+    std::cout << "acquire latency (us) , 4 permits , batch = 1..maxBatch permits per acquire\n";
+    std::cout << "mode\tthreads\tmaxBatch\tp50\tp99\tp999\tmax\n";
+    for (int threadCount : { 4, 16, 64 }) {
+        for (int maxBatch : { 1, 3 }) {
+            printRow<futex_counting_semaphore<4>>("unfair", threadCount, maxBatch);
+            printRow<fair_counting_semaphore<4>>("fair", threadCount, maxBatch);
+        }
+    }
+    return 0;
+}
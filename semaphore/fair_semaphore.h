@@ -0,0 +1,239 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stop_token>
+#include "futex_semaphore.h"
+
+/*
+fair_counting_semaphore<N> : FIFO-fair counting semaphore with batched acquire (Linux only)
+-same API as futex_counting_semaphore : acquire(n) , try_acquire(n) , try_acquire_for(n , d) ,
+    try_acquire_until(n , t) , release(n)
+-waiters form a FIFO queue , permits are handed over in arrival order :
+    release() grants permits to the head of the queue as long as they suffice ,
+    a newcomer never takes permits while somebody is queued (no barging)
+-strict FIFO also for batches : a waiter that needs 3 permits blocks a later one that needs 1 ,
+    otherwise a large request could starve forever behind a stream of small ones
+-every waiter sleeps on its OWN futex word (Waiter::state) --> release wakes exactly the granted
+    threads , no thundering herd and no "wake , re-check , sleep again"
+-the queue is an intrusive list of stack-allocated nodes protected by a mutex : no allocation ,
+    and a timed-out waiter unlinks itself in O(1)
+-acquire(stop_token , n) : false once stop is requested , the stop callback unlinks the waiter and writes
+    Cancelled into its futex word --> a cancellable wait without polling and without a lost wakeup
+cost : the mutex on every call , fairness is paid with throughput --> use it where tail latency matters
+*/
+
+template <std::ptrdiff_t LeastMaxValue = std::numeric_limits<std::int32_t>::max()>
+class fair_counting_semaphore {
+    static_assert(LeastMaxValue >= 0 && LeastMaxValue <= std::numeric_limits<std::int32_t>::max());
+
+public:
+    explicit fair_counting_semaphore(std::ptrdiff_t desired) : m_count{desired} {
+        assert(desired >= 0 && desired <= LeastMaxValue);
+    }
+
+    fair_counting_semaphore(const fair_counting_semaphore&) = delete;
+    fair_counting_semaphore& operator=(const fair_counting_semaphore&) = delete;
+
+    static constexpr std::ptrdiff_t max() noexcept { return LeastMaxValue; }
+
+    void acquire(std::ptrdiff_t permits = 1) {
+        Waiter waiter{permits};
+        if (enqueueOrTake(waiter)) {
+            return;
+        }
+        park(waiter, nullptr);
+    }
+
+    //false when stop was requested before the permits were granted
+    bool acquire(std::stop_token stop, std::ptrdiff_t permits = 1) {
+        if (stop.stop_requested()) {
+            return false;
+        }
+        Waiter waiter{permits};
+        if (enqueueOrTake(waiter)) {
+            return true;
+        }
+        //~stop_callback waits for a running callback : the stack node outlives every use of it
+        std::stop_callback cancel{stop, [this, &waiter] { cancelWaiter(waiter); }};
+        return park(waiter, nullptr);
+    }
+
+    bool try_acquire(std::ptrdiff_t permits = 1) {
+        assert(permits > 0 && permits <= LeastMaxValue);
+        std::lock_guard lock{m_mutex};
+        if (m_head == nullptr && m_count >= permits) {
+            m_count -= permits;
+            return true;
+        }
+        return false;
+    }
+
+    template <typename Rep, typename Period>
+    bool try_acquire_for(const std::chrono::duration<Rep, Period>& relTime) {
+        return try_acquire_for(1, relTime);
+    }
+
+    template <typename Clock, typename Duration>
+    bool try_acquire_until(const std::chrono::time_point<Clock, Duration>& absTime) {
+        return try_acquire_until(1, absTime);
+    }
+
+    template <typename Rep, typename Period>
+    bool try_acquire_for(std::ptrdiff_t permits, const std::chrono::duration<Rep, Period>& relTime) {
+        return try_acquire_until(permits, std::chrono::steady_clock::now() + relTime);
+    }
+
+    template <typename Clock, typename Duration>
+    bool try_acquire_until(std::ptrdiff_t permits, const std::chrono::time_point<Clock, Duration>& absTime) {
+        Waiter waiter{permits};
+        if (enqueueOrTake(waiter)) {
+            return true;
+        }
+        for (;;) {
+            const auto remaining{absTime - Clock::now()};
+            if (remaining <= decltype(remaining)::zero()) {
+                break;
+            }
+            const timespec timeout{futex_detail::toTimespec(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(remaining))};
+            if (park(waiter, &timeout)) {
+                return true;
+            }
+        }
+        //timed out : leave the queue , unless release() has already handed us the permits
+        std::unique_lock lock{m_mutex};
+        if (!waiter.queued) {
+            lock.unlock();
+            park(waiter, nullptr); //granted , only the store of the state may still be on its way
+            return true;
+        }
+        unlink(waiter);
+        //we may have been the head that blocked smaller requests behind us
+        Waiter* granted{grantFromHead()};
+        lock.unlock();
+        wakeAll(granted);
+        return false;
+    }
+
+    void release(std::ptrdiff_t update = 1) {
+        std::unique_lock lock{m_mutex};
+        assert(update >= 0 && m_count + update <= LeastMaxValue);
+        m_count += update;
+        Waiter* granted{grantFromHead()};
+        lock.unlock();
+        wakeAll(granted); //outside the lock : a woken thread does not block on m_mutex at once
+    }
+
+private:
+    enum : std::int32_t { Waiting, Parked, Granted, Cancelled }; //Granted and Cancelled are final
+
+    struct Waiter {
+        explicit Waiter(std::ptrdiff_t n) : permits{n} {}
+        std::ptrdiff_t permits;
+        Waiter* prev{nullptr};
+        Waiter* next{nullptr};
+        bool queued{false};                       //guarded by m_mutex
+        std::atomic<std::int32_t> state{Waiting}; //the futex word of this waiter only
+    };
+
+    //true : the permits were free and nobody was queued , taken
+    //every acquire goes through here : permits in [1 , max()] , <= 0 would create permits , > max() never fits
+    bool enqueueOrTake(Waiter& waiter) {
+        assert(waiter.permits > 0 && waiter.permits <= LeastMaxValue);
+        std::lock_guard lock{m_mutex};
+        if (m_head == nullptr && m_count >= waiter.permits) {
+            m_count -= waiter.permits;
+            return true;
+        }
+        waiter.prev = m_tail;
+        (m_tail ? m_tail->next : m_head) = &waiter;
+        m_tail = &waiter;
+        waiter.queued = true;
+        return false;
+    }
+
+    void unlink(Waiter& waiter) {
+        (waiter.prev ? waiter.prev->next : m_head) = waiter.next;
+        (waiter.next ? waiter.next->prev : m_tail) = waiter.prev;
+        waiter.queued = false;
+    }
+
+    //under m_mutex : hand permits to the head while they suffice , returns the granted waiters
+    //as a chain linked through `next` (the nodes are no longer in the queue)
+    Waiter* grantFromHead() {
+        Waiter* first{nullptr};
+        Waiter** last{&first};
+        while (m_head != nullptr && m_head->permits <= m_count) {
+            Waiter* waiter{m_head};
+            m_count -= waiter->permits;
+            unlink(*waiter);
+            waiter->next = nullptr;
+            *last = waiter;
+            last = &waiter->next;
+        }
+        return first;
+    }
+
+    //after the exchange the waiter may return and its stack node be gone :
+    //read `next` before , and a FUTEX_WAKE on the stale (still mapped) stack address is harmless
+    static void wakeAll(Waiter* waiter) {
+        while (waiter != nullptr) {
+            Waiter* next{waiter->next};
+            settle(*waiter, Granted);
+            waiter = next;
+        }
+    }
+
+    static void settle(Waiter& waiter, std::int32_t outcome) {
+        std::atomic<std::int32_t>& state{waiter.state};
+        if (state.exchange(outcome, std::memory_order_release) == Parked) {
+            futex_detail::wake(state, 1);
+        }
+    }
+
+    //the stop callback : leave the queue , unless release() has already handed us the permits
+    void cancelWaiter(Waiter& waiter) {
+        std::unique_lock lock{m_mutex};
+        if (!waiter.queued) {
+            return;
+        }
+        unlink(waiter);
+        Waiter* granted{grantFromHead()}; //we may have been the head that blocked smaller requests
+        lock.unlock();
+        wakeAll(granted);
+        settle(waiter, Cancelled);
+    }
+
+    //true once granted , false on timeout or cancellation
+    static bool park(Waiter& waiter, const timespec* timeout) {
+        //a short spin first : the hand-over often comes within a few hundred cycles
+        for (int i = 0; i < 100; ++i) {
+            const std::int32_t state{waiter.state.load(std::memory_order_acquire)};
+            if (state >= Granted) {
+                return state == Granted;
+            }
+            futex_detail::cpuRelax();
+        }
+        std::int32_t state{Waiting};
+        if (!waiter.state.compare_exchange_strong(state, Parked, std::memory_order_acquire) && state >= Granted) {
+            return state == Granted;
+        }
+        //with a timeout : one wait , the caller recomputes the remaining time and calls again
+        do {
+            futex_detail::wait(waiter.state, Parked, timeout);
+        } while (timeout == nullptr && waiter.state.load(std::memory_order_acquire) < Granted);
+        return waiter.state.load(std::memory_order_acquire) == Granted;
+    }
+
+    std::mutex m_mutex;
+    std::ptrdiff_t m_count;
+    Waiter* m_head{nullptr};
+    Waiter* m_tail{nullptr};
+};
+
+using fair_binary_semaphore = fair_counting_semaphore<1>;
@@ -0,0 +1,105 @@
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <semaphore>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "futex_semaphore.h"
+
+//g++ -std=c++20 -O2 -pthread futex_semaphore.cpp -o futex_semaphore
+
+//the "Example Implementation" from README.md : mutex + condition_variable on every call
+template <ptrdiff_t LeastMaxValue>
+class readme_counting_semaphore {
+private:
+    ptrdiff_t counter;
+    ptrdiff_t max_count;
+    std::mutex mutex;
+    std::condition_variable cv;
+
+public:
+    explicit readme_counting_semaphore(ptrdiff_t desired)
+        : counter(desired), max_count(LeastMaxValue) {
+        if (desired < 0 || desired > LeastMaxValue) {
+            throw std::logic_error("Semaphore count out of range");
+        }
+    }
+
+    void acquire() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return counter > 0; });
+        --counter;
+    }
+
+    void release(ptrdiff_t update = 1) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (update < 0 || counter + update > max_count) {
+            throw std::logic_error("Semaphore release exceeds max_count");
+        }
+        counter += update;
+        lock.unlock();
+        cv.notify_one();
+    }
+};
+
+//every thread : acquire , a little work , release --> million operations per second
+template <typename Semaphore>
+double benchmark(int threadCount, int permits, int iterations) {
+    Semaphore sem(permits);
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&] {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            volatile int work = 0;
+            for (int i = 0; i < iterations; ++i) {
+                sem.acquire();
+                for (int w = 0; w < 20; ++w) work = work + w;
+                sem.release();
+            }
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return threadCount * static_cast<double>(iterations) / seconds / 1e6;
+}
+
+void worker(futex_counting_semaphore<3>& sem, int id) {
+    sem.acquire(); // Acquire a permit (max 3)
+    std::cout << "Worker " << id << " acquired resource\n";
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // Simulate work
+    std::cout << "Worker " << id << " releasing resource\n";
+    sem.release(); // Release the permit
+}
+
+int main() {
+    //Example 1 of README.md with the futex semaphore
+    futex_counting_semaphore<3> sem(3);
+    std::thread threads[5];
+    for (int i = 0; i < 5; ++i) {
+        threads[i] = std::thread(worker, std::ref(sem), i + 1);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    futex_binary_semaphore empty(0);
+    std::cout << "try_acquire_for on an empty semaphore : "
+              << (empty.try_acquire_for(std::chrono::milliseconds(20)) ? "acquired" : "timed out") << "\n\n";
+
+    constexpr int iterations = 50'000;
+    std::cout << "Mops/s (acquire + release) , 4 permits\n";
+    std::cout << "threads\treadme(mutex+cv)\tstd::counting_semaphore\tfutex\n";
+    for (int threadCount : { 1, 2, 4, 8, 16, 32, 64 }) {
+        const int perThread = iterations / threadCount + 1000;
+        std::cout << threadCount << "\t"
+                  << benchmark<readme_counting_semaphore<4>>(threadCount, 4, perThread) << "\t\t\t"
+                  << benchmark<std::counting_semaphore<4>>(threadCount, 4, perThread) << "\t\t\t"
+                  << benchmark<futex_counting_semaphore<4>>(threadCount, 4, perThread) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,197 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/*
+futex_counting_semaphore<N> : drop-in for the readme counting_semaphore / std::counting_semaphore (Linux only)
+-the counter itself is the futex word : no mutex , no condition_variable
+-fast path (nobody waits)
+    acquire() --> one CAS  (count , count - 1) , acquire(n) --> one CAS (count , count - n)
+    release() --> one fetch_add + one load of m_waiters , NO system call
+-slow path
+    1-spin with `pause` for a bounded number of rounds (self-tuning , see m_spinLimit)
+    2-park : ++m_waiters , FUTEX_WAIT while the count is still the value that was too small
+    release() calls FUTEX_WAKE only when m_waiters != 0
+-unfair : a thread arriving at the right moment can take the permits before a sleeping waiter
+    (fair_semaphore.h has the FIFO-fair version)
+-lost wake-up is impossible :
+    waiter  : ++m_waiters (seq_cst) ; load count ; FUTEX_WAIT(expected count)
+    release : count += n (seq_cst) ; load m_waiters
+    either the waiter sees the new count , or release sees the waiter ,
+    and FUTEX_WAIT itself re-checks the word atomically in the kernel
+*/
+
+namespace futex_detail {
+    inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    //returns false on timeout
+    inline bool wait(std::atomic<std::int32_t>& word, std::int32_t expected, const timespec* timeout = nullptr) {
+        static_assert(sizeof(std::atomic<std::int32_t>) == sizeof(std::int32_t) &&
+                      std::atomic<std::int32_t>::is_always_lock_free);
+        const long result{syscall(SYS_futex, reinterpret_cast<std::int32_t*>(&word), FUTEX_WAIT_PRIVATE,
+                                  expected, timeout, nullptr, 0)};
+        return !(result == -1 && errno == ETIMEDOUT);
+    }
+
+    inline void wake(std::atomic<std::int32_t>& word, std::int32_t count) {
+        syscall(SYS_futex, reinterpret_cast<std::int32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+    }
+
+    inline timespec toTimespec(std::chrono::nanoseconds duration) {
+        const auto seconds{std::chrono::duration_cast<std::chrono::seconds>(duration)};
+        return { static_cast<time_t>(seconds.count()), static_cast<long>((duration - seconds).count()) };
+    }
+}
+
+template <std::ptrdiff_t LeastMaxValue = std::numeric_limits<std::int32_t>::max()>
+class futex_counting_semaphore {
+    static_assert(LeastMaxValue >= 0 && LeastMaxValue <= std::numeric_limits<std::int32_t>::max(),
+                  "the futex word is 32 bits");
+
+public:
+    explicit futex_counting_semaphore(std::ptrdiff_t desired) : m_count{static_cast<std::int32_t>(desired)} {
+        assert(desired >= 0 && desired <= LeastMaxValue);
+    }
+
+    futex_counting_semaphore(const futex_counting_semaphore&) = delete;
+    futex_counting_semaphore& operator=(const futex_counting_semaphore&) = delete;
+
+    static constexpr std::ptrdiff_t max() noexcept { return LeastMaxValue; }
+
+    void acquire() noexcept { acquire(1); }
+    bool try_acquire() noexcept { return try_acquire(1); }
+
+    template <typename Rep, typename Period>
+    bool try_acquire_for(const std::chrono::duration<Rep, Period>& relTime) {
+        return try_acquire_until(1, std::chrono::steady_clock::now() + relTime);
+    }
+
+    template <typename Clock, typename Duration>
+    bool try_acquire_until(const std::chrono::time_point<Clock, Duration>& absTime) {
+        return try_acquire_until(1, absTime);
+    }
+
+    //batched : takes `permits` at once or nothing (never holds a part while waiting)
+    //permits in [1 , max()] : <= 0 would create permits , > max() would park forever
+    void acquire(std::ptrdiff_t permits) noexcept {
+        assert(permits > 0 && permits <= LeastMaxValue);
+        if (try_acquire(permits) || spinAcquire(permits)) {
+            return;
+        }
+        const WaiterScope waiter{*this, permits};
+        for (std::int32_t count = m_count.load(std::memory_order_seq_cst); !tryTake(count, permits);) {
+            futex_detail::wait(m_count, count); //returns at once if the count changed meanwhile
+            count = m_count.load(std::memory_order_relaxed);
+        }
+    }
+
+    bool try_acquire(std::ptrdiff_t permits) noexcept {
+        assert(permits > 0 && permits <= LeastMaxValue);
+        return tryTake(m_count.load(std::memory_order_relaxed), permits);
+    }
+
+    template <typename Rep, typename Period>
+    bool try_acquire_for(std::ptrdiff_t permits, const std::chrono::duration<Rep, Period>& relTime) {
+        return try_acquire_until(permits, std::chrono::steady_clock::now() + relTime);
+    }
+
+    template <typename Clock, typename Duration>
+    bool try_acquire_until(std::ptrdiff_t permits, const std::chrono::time_point<Clock, Duration>& absTime) {
+        assert(permits > 0 && permits <= LeastMaxValue);
+        if (try_acquire(permits) || spinAcquire(permits)) {
+            return true;
+        }
+        const WaiterScope waiter{*this, permits};
+        for (std::int32_t count = m_count.load(std::memory_order_seq_cst); !tryTake(count, permits);) {
+            const auto remaining{absTime - Clock::now()};
+            if (remaining <= Duration::zero()) {
+                return false;
+            }
+            const timespec timeout{futex_detail::toTimespec(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(remaining))};
+            futex_detail::wait(m_count, count, &timeout);
+            count = m_count.load(std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    void release(std::ptrdiff_t update = 1) noexcept {
+        assert(update >= 0 && m_count.load(std::memory_order_relaxed) + update <= LeastMaxValue);
+        m_count.fetch_add(static_cast<std::int32_t>(update), std::memory_order_seq_cst);
+        if (m_waiters.load(std::memory_order_seq_cst) != 0) {
+            //a woken single-permit waiter always makes progress , a batched one may go back to sleep
+            //while another could have run --> wake everybody as soon as a batched waiter exists
+            const bool batched{m_batchedWaiters.load(std::memory_order_relaxed) != 0};
+            futex_detail::wake(m_count, batched ? std::numeric_limits<std::int32_t>::max()
+                                                : static_cast<std::int32_t>(update));
+        }
+    }
+
+private:
+    static constexpr std::int32_t MinSpin{16};
+    static constexpr std::int32_t MaxSpin{4000};
+
+    //adaptive spin : if spinning paid off , spin a bit longer next time , otherwise back off
+    //the estimate is shared and updated with relaxed atomics , it is only a hint
+    bool spinAcquire(std::ptrdiff_t permits) noexcept {
+        const std::int32_t limit{m_spinLimit.load(std::memory_order_relaxed)};
+        for (std::int32_t i = 0; i < limit; ++i) {
+            futex_detail::cpuRelax();
+            if (m_count.load(std::memory_order_relaxed) >= permits && try_acquire(permits)) {
+                m_spinLimit.store(std::min(MaxSpin, limit + (2 * i - limit) / 8 + 1), std::memory_order_relaxed);
+                return true;
+            }
+        }
+        m_spinLimit.store(std::max(MinSpin, limit - limit / 8), std::memory_order_relaxed);
+        return false;
+    }
+
+    //CAS loop starting from an already loaded `count` (updated on failure)
+    bool tryTake(std::int32_t count, std::ptrdiff_t permits) noexcept {
+        assert(permits > 0 && permits <= LeastMaxValue);
+        while (count >= permits) {
+            if (m_count.compare_exchange_weak(count, count - static_cast<std::int32_t>(permits),
+                                              std::memory_order_acquire, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //registered waiter for the lifetime of the scope (also on the timeout path)
+    struct WaiterScope {
+        futex_counting_semaphore& sem;
+        bool batched;
+        WaiterScope(futex_counting_semaphore& s, std::ptrdiff_t permits) : sem{s}, batched{permits > 1} {
+            if (batched) sem.m_batchedWaiters.fetch_add(1, std::memory_order_relaxed);
+            sem.m_waiters.fetch_add(1, std::memory_order_seq_cst);
+        }
+        ~WaiterScope() {
+            sem.m_waiters.fetch_sub(1, std::memory_order_relaxed);
+            if (batched) sem.m_batchedWaiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(64) std::atomic<std::int32_t> m_count;
+    std::atomic<std::int32_t> m_waiters{0};
+    std::atomic<std::int32_t> m_batchedWaiters{0};
+    std::atomic<std::int32_t> m_spinLimit{200};
+};
+
+using futex_binary_semaphore = futex_counting_semaphore<1>;
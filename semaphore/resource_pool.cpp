@@ -0,0 +1,97 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "fair_semaphore.h"
+#include "resource_pool.h"
+
+//g++ -std=c++20 -O2 -pthread resource_pool.cpp -o resource_pool
+
+std::mutex coutMutex;
+
+class DatabaseConnection {
+public:
+    explicit DatabaseConnection(int id) : m_id{id} {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10)); //connecting is expensive
+    }
+    std::string query(const std::string& sql) const { return "connection " + std::to_string(m_id) + " : " + sql; }
+    int getId() const { return m_id; }
+
+private:
+    int m_id;
+};
+
+template <typename Pool>
+void worker(Pool& pool, int id) {
+    auto connection = pool.acquire(); //blocks while all 3 connections are leased
+    {
+        std::lock_guard lock{coutMutex};
+        std::cout << "Worker " << id << " got " << connection->query("SELECT 1") << "\n";
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); //Simulate work
+}                                                               //~Lease gives the connection back
+
+void printMetrics(const ResourcePoolMetrics& m) {
+    using std::chrono::duration;
+    std::cout << "acquisitions " << m.acquisitions << " , timeouts " << m.timeouts << " , built " << m.created
+              << " in " << duration<double, std::micro>(m.totalBuild).count() << " us , cache hits " << m.cacheHits << "\n"
+              << "wait mean " << duration<double, std::micro>(m.meanWait()).count() << " us , max "
+              << duration<double, std::micro>(m.maxWait).count() << " us , hold mean "
+              << duration<double, std::micro>(m.meanHold()).count() << " us , utilization "
+              << m.utilization * 100 << " %\n";
+}
+
+//many short leases : throughput and how often a thread gets its own connection back
+template <typename Pool>
+void benchmark(const char* name, int threadCount, int iterations) {
+    std::atomic<int> nextId{0};
+    Pool pool(4, [&] { return std::make_unique<DatabaseConnection>(nextId++); });
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&] {
+            volatile int work = 0;
+            for (int i = 0; i < iterations; ++i) {
+                auto connection = pool.acquire();
+                for (int w = 0; w < 100; ++w) work = work + connection->getId();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "\n" << name << " , " << threadCount << " threads , 4 connections : "
+              << threadCount * static_cast<double>(iterations) / seconds / 1e6 << " M leases/s\n";
+    printMetrics(pool.metrics());
+}
+
+int main() {
+    //Example 1 of README.md : 5 workers , 3 database connections , built on first use
+    std::atomic<int> nextId{1}; //the factory runs on the acquiring threads , concurrently
+    ResourcePool<DatabaseConnection> pool(3, [&] { return std::make_unique<DatabaseConnection>(nextId++); });
+    std::thread threads[5];
+    for (int i = 0; i < 5; ++i) {
+        threads[i] = std::thread([&pool, i] { worker(pool, i + 1); });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    printMetrics(pool.metrics());
+
+    //timeout : every connection is leased
+    std::vector<ResourcePool<DatabaseConnection>::Lease> all;
+    for (int i = 0; i < 3; ++i) all.push_back(pool.acquire());
+    auto none = pool.try_acquire_for(std::chrono::milliseconds(20));
+    std::cout << "try_acquire_for(20ms) with 3 leases out : " << (none ? "acquired" : "timed out") << "\n";
+    auto moved = std::move(all.back()); //leases are move-only
+    all.clear();
+    moved.release();                    //early return
+    std::cout << "leases out after release : " << pool.metrics().inUse << "\n";
+
+    benchmark<ResourcePool<DatabaseConnection>>("futex semaphore", 8, 100'000);
+    benchmark<ResourcePool<DatabaseConnection, fair_counting_semaphore<>>>("fair semaphore", 8, 20'000);
+    return 0;
+}
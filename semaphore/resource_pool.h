@@ -0,0 +1,281 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include "futex_semaphore.h"
+
+/*
+ResourcePool<T> : Example 1 of README.md ("3 database connections for 5 workers") where the
+worker actually RECEIVES a connection
+-the semaphore counts the free resources : a permit means "one slot is free for you"
+-acquire() returns a Lease : move-only RAII handle , the resource goes back in ~Lease()
+-lazy : a resource is built by the factory the first time its slot is handed out
+    (on the acquiring thread , outside any lock --> the factory must be thread-safe)
+-per-thread cache : every thread remembers the slots it used last and tries them first
+    (warm CPU caches , and a connection keeps serving the same thread)
+-slot claim = CAS on Slot::inUse , the cache is only a hint , a scan finds the free slot otherwise
+-metrics : wait time , hold time , utilization , timeouts , resources built , time spent building them
+    (wait = permit + slot , it stops before the factory runs : a first lease does not look contended)
+*/
+
+struct ResourcePoolMetrics {
+    std::uint64_t acquisitions{};
+    std::uint64_t timeouts{};
+    std::uint64_t created{};        //resources built so far
+    std::uint64_t cacheHits{};      //slot found through the per-thread cache
+    std::size_t inUse{};            //leases out right now
+    std::chrono::nanoseconds totalWait{};
+    std::chrono::nanoseconds maxWait{};
+    std::chrono::nanoseconds totalHold{};
+    std::chrono::nanoseconds totalBuild{}; //in the factory , not part of the wait
+    double utilization{};           //totalHold / (capacity * lifetime of the pool) , in [0 , 1]
+
+    std::chrono::nanoseconds meanWait() const { return totalWait / std::max<std::int64_t>(1, acquisitions); }
+    std::chrono::nanoseconds meanHold() const { return totalHold / std::max<std::int64_t>(1, acquisitions); }
+};
+
+template <typename T, typename Semaphore = futex_counting_semaphore<>>
+class ResourcePool {
+public:
+    using Factory = std::function<std::unique_ptr<T>()>;
+
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease(Lease&& rhs) noexcept
+            : m_pool{std::exchange(rhs.m_pool, nullptr)}, m_slot{rhs.m_slot}, m_since{rhs.m_since} {}
+        Lease& operator=(Lease&& rhs) noexcept {
+            if (this != &rhs) {
+                release();
+                m_pool = std::exchange(rhs.m_pool, nullptr);
+                m_slot = rhs.m_slot;
+                m_since = rhs.m_since;
+            }
+            return *this;
+        }
+        ~Lease() { release(); }
+
+        T& operator*() const { return *get(); }
+        T* operator->() const { return get(); }
+        T* get() const { return m_pool ? m_pool->m_slots[m_slot].resource.get() : nullptr; }
+        explicit operator bool() const { return m_pool != nullptr; }
+
+        //gives the resource back before the end of the scope
+        void release() noexcept {
+            if (m_pool) {
+                std::exchange(m_pool, nullptr)->giveBack(m_slot, m_since);
+            }
+        }
+
+    private:
+        friend class ResourcePool;
+        Lease(ResourcePool* pool, std::uint32_t slot) : m_pool{pool}, m_slot{slot}, m_since{Clock::now()} {}
+
+        ResourcePool* m_pool{nullptr};
+        std::uint32_t m_slot{};
+        std::chrono::steady_clock::time_point m_since{};
+    };
+
+    ResourcePool(std::size_t capacity, Factory factory);
+    ~ResourcePool() { assert(m_inUse.load() == 0 && "a Lease outlives its ResourcePool"); }
+
+    ResourcePool(const ResourcePool&) = delete;
+    ResourcePool& operator=(const ResourcePool&) = delete;
+
+    //blocks until a resource is free , rethrows if the factory throws (nothing is leaked)
+    Lease acquire();
+    //std::nullopt on timeout
+    template <typename Rep, typename Period>
+    std::optional<Lease> try_acquire_for(const std::chrono::duration<Rep, Period>& relTime);
+
+    std::size_t capacity() const { return m_capacity; }
+    ResourcePoolMetrics metrics() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::size_t CacheEntries{4};
+
+    struct alignas(64) Slot {
+        std::atomic<bool> inUse{false};
+        std::unique_ptr<T> resource; //written only by the thread that claimed the slot
+    };
+
+    //per-thread MRU list of {pool id , slot} , ids instead of pointers : a new pool may reuse an address
+    struct CacheEntry {
+        std::uint64_t pool{0};
+        std::uint32_t slot{0};
+    };
+    static CacheEntry* threadCache() {
+        thread_local CacheEntry cache[CacheEntries];
+        return cache;
+    }
+
+    //before m_slots and m_free are built : a huge capacity must throw , not allocate
+    static std::size_t checkedCapacity(std::size_t capacity) {
+        if (capacity == 0 || capacity > static_cast<std::size_t>(Semaphore::max())) {
+            throw std::invalid_argument{"ResourcePool capacity out of range"};
+        }
+        return capacity;
+    }
+
+    Lease claim(Clock::time_point waitStart);
+    void giveBack(std::uint32_t slot, Clock::time_point since) noexcept;
+    bool tryClaim(std::uint32_t slot) {
+        return !m_slots[slot].inUse.load(std::memory_order_relaxed) &&
+               !m_slots[slot].inUse.exchange(true, std::memory_order_acquire);
+    }
+    static void atomicMax(std::atomic<std::int64_t>& target, std::int64_t value) {
+        for (std::int64_t current = target.load(std::memory_order_relaxed);
+             current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed);) {
+        }
+    }
+
+    const std::size_t m_capacity;
+    const std::uint64_t m_id;
+    const Clock::time_point m_born{Clock::now()};
+    Factory m_factory;
+    std::unique_ptr<Slot[]> m_slots;
+    Semaphore m_free;
+
+    std::atomic<std::uint64_t> m_acquisitions{0};
+    std::atomic<std::uint64_t> m_timeouts{0};
+    std::atomic<std::uint64_t> m_created{0};
+    std::atomic<std::uint64_t> m_cacheHits{0};
+    std::atomic<std::size_t> m_inUse{0};
+    std::atomic<std::int64_t> m_waitNs{0};
+    std::atomic<std::int64_t> m_maxWaitNs{0};
+    std::atomic<std::int64_t> m_holdNs{0};
+    std::atomic<std::int64_t> m_buildNs{0};
+};
+
+inline std::uint64_t nextResourcePoolId() {
+    static std::atomic<std::uint64_t> id{0};
+    return ++id;
+}
+
+template <typename T, typename Semaphore>
+ResourcePool<T, Semaphore>::ResourcePool(std::size_t capacity, Factory factory)
+    : m_capacity{checkedCapacity(capacity)}, m_id{nextResourcePoolId()}, m_factory{std::move(factory)},
+      m_slots{std::make_unique<Slot[]>(m_capacity)}, m_free{static_cast<std::ptrdiff_t>(m_capacity)} {
+    if (!m_factory) {
+        throw std::invalid_argument{"ResourcePool needs a factory"};
+    }
+}
+
+template <typename T, typename Semaphore>
+typename ResourcePool<T, Semaphore>::Lease ResourcePool<T, Semaphore>::acquire() {
+    const auto start{Clock::now()};
+    m_free.acquire();
+    return claim(start);
+}
+
+template <typename T, typename Semaphore>
+template <typename Rep, typename Period>
+std::optional<typename ResourcePool<T, Semaphore>::Lease>
+ResourcePool<T, Semaphore>::try_acquire_for(const std::chrono::duration<Rep, Period>& relTime) {
+    const auto start{Clock::now()};
+    if (!m_free.try_acquire_for(relTime)) {
+        m_timeouts.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    return claim(start);
+}
+
+//we own a permit --> at least one slot is free , the loop ends
+template <typename T, typename Semaphore>
+typename ResourcePool<T, Semaphore>::Lease ResourcePool<T, Semaphore>::claim(Clock::time_point waitStart) {
+    CacheEntry* cache{threadCache()};
+    std::uint32_t slot{static_cast<std::uint32_t>(m_capacity)};
+    for (std::size_t i = 0; i < CacheEntries; ++i) {
+        if (cache[i].pool == m_id && tryClaim(cache[i].slot)) {
+            slot = cache[i].slot;
+            m_cacheHits.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+    }
+    //lowest free slot first : built resources are reused before a new one is built
+    while (slot == m_capacity) {
+        for (std::uint32_t i = 0; i < m_capacity; ++i) {
+            if (tryClaim(i)) {
+                slot = i;
+                break;
+            }
+        }
+    }
+
+    //permit and slot are ours : the wait ends here , building the resource is not contention
+    const auto claimedAt{Clock::now()};
+    const std::int64_t waited{std::chrono::duration_cast<std::chrono::nanoseconds>(claimedAt - waitStart).count()};
+    Slot& claimed{m_slots[slot]};
+    if (!claimed.resource) {
+        try {
+            claimed.resource = m_factory();
+            if (!claimed.resource) {
+                throw std::runtime_error{"ResourcePool factory returned nullptr"};
+            }
+        } catch (...) {
+            claimed.inUse.store(false, std::memory_order_release);
+            m_free.release();
+            throw;
+        }
+        m_created.fetch_add(1, std::memory_order_relaxed);
+        m_buildNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - claimedAt).count(),
+                            std::memory_order_relaxed);
+    }
+
+    m_waitNs.fetch_add(waited, std::memory_order_relaxed);
+    atomicMax(m_maxWaitNs, waited);
+    m_acquisitions.fetch_add(1, std::memory_order_relaxed);
+    m_inUse.fetch_add(1, std::memory_order_relaxed);
+    return Lease{this, slot};
+}
+
+template <typename T, typename Semaphore>
+void ResourcePool<T, Semaphore>::giveBack(std::uint32_t slot, Clock::time_point since) noexcept {
+    m_holdNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count(),
+                       std::memory_order_relaxed);
+    m_inUse.fetch_sub(1, std::memory_order_relaxed);
+
+    //move {pool , slot} to the front of this thread's cache
+    CacheEntry* cache{threadCache()};
+    const CacheEntry entry{m_id, slot};
+    std::size_t i{0};
+    while (i + 1 < CacheEntries && !(cache[i].pool == m_id && cache[i].slot == slot)) {
+        ++i;
+    }
+    std::move_backward(cache, cache + i, cache + i + 1);
+    cache[0] = entry;
+
+    m_slots[slot].inUse.store(false, std::memory_order_release);
+    m_free.release();
+}
+
+template <typename T, typename Semaphore>
+ResourcePoolMetrics ResourcePool<T, Semaphore>::metrics() const {
+    ResourcePoolMetrics result;
+    result.acquisitions = m_acquisitions.load(std::memory_order_relaxed);
+    result.timeouts = m_timeouts.load(std::memory_order_relaxed);
+    result.created = m_created.load(std::memory_order_relaxed);
+    result.cacheHits = m_cacheHits.load(std::memory_order_relaxed);
+    result.inUse = m_inUse.load(std::memory_order_relaxed);
+    result.totalWait = std::chrono::nanoseconds{m_waitNs.load(std::memory_order_relaxed)};
+    result.maxWait = std::chrono::nanoseconds{m_maxWaitNs.load(std::memory_order_relaxed)};
+    result.totalHold = std::chrono::nanoseconds{m_holdNs.load(std::memory_order_relaxed)};
+    result.totalBuild = std::chrono::nanoseconds{m_buildNs.load(std::memory_order_relaxed)};
+    const auto lifetime{std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_born)};
+    if (lifetime.count() > 0) {
+        result.utilization = std::min(1.0, static_cast<double>(result.totalHold.count()) /
+                                           (static_cast<double>(m_capacity) * static_cast<double>(lifetime.count())));
+    }
+    return result;
+}
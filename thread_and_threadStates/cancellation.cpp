@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <iostream>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <syncstream>
+#include <thread>
+#include <vector>
+#include "../condition_variable/batching_channel.h"
+#include "../condition_variable/mpmc_ring.h"
+#include "../semaphore/fair_semaphore.h"
+#include "cancellation.h"
+
+//g++ -std=c++20 -O2 -pthread cancellation.cpp -o cancellation
+
+using Clock = std::chrono::steady_clock;
+
+//readme.md , without the bool & state : the chief cooks until the main chief says stop
+void chief(std::stop_token stop, int chiefNumber, mpmc_ring<std::string>& orders) {
+    std::string order;
+    while (orders.pop(order, stop)) { //blocks while there is nothing to cook , returns false on stop
+        std::osyncstream(std::cout) << "chief " << chiefNumber << " : " << order << " is ready!\n";
+    }
+    std::osyncstream(std::cout) << "chief " << chiefNumber << " : stop requested , going home\n";
+}
+
+double cpuSeconds() {
+    timespec ts{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+struct Result {
+    double meanLatencyMicros{0};
+    double maxLatencyMicros{0};
+    double idleCpuPercent{0}; //of one core , all chiefs together
+};
+
+//rounds x : start the chiefs , let them idle , request_stop() every one of them ,
+//latency = from the first request_stop() to the moment the LAST chief has left its wait
+template <typename Wait>
+Result measure(int chiefs, Wait wait) {
+    constexpr int rounds = 10;
+    constexpr auto idle = std::chrono::milliseconds(100);
+    Result result;
+    double cpu = 0;
+    double idleSeconds = 0;
+    for (int r = 0; r < rounds; ++r) {
+        std::vector<Clock::time_point> left(chiefs);
+        std::vector<std::jthread> team;
+        for (int i = 0; i < chiefs; ++i) {
+            team.emplace_back([&wait, &left, i](std::stop_token stop) {
+                wait(stop);
+                left[i] = Clock::now();
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10)); //let them reach their wait
+        const double cpuStart = cpuSeconds();
+        const auto idleStart = Clock::now();
+        std::this_thread::sleep_for(idle + std::chrono::microseconds(1100 * r)); //stop at another phase of a poll
+        cpu += cpuSeconds() - cpuStart;
+        idleSeconds += std::chrono::duration<double>(Clock::now() - idleStart).count();
+        const auto stopAt = Clock::now();
+        for (auto& c : team) c.request_stop();
+        for (auto& c : team) c.join();
+        const double latency =
+            std::chrono::duration<double, std::micro>(*std::max_element(left.begin(), left.end()) - stopAt).count();
+        result.meanLatencyMicros += latency / rounds;
+        result.maxLatencyMicros = std::max(result.maxLatencyMicros, latency);
+    }
+    result.idleCpuPercent = 100.0 * cpu / idleSeconds;
+    return result;
+}
+
+template <typename Wait>
+void row(const char* name, int chiefs, Wait wait) {
+    const Result r = measure(chiefs, wait);
+    std::cout << name << "\t" << static_cast<long>(r.meanLatencyMicros) << "\t"
+              << static_cast<long>(r.maxLatencyMicros) << "\t" << r.idleCpuPercent << "\n";
+}
+
+int main() {
+    //the kitchen : ~jthread() requests stop and joins , the chiefs leave pop() at once
+    {
+        mpmc_ring<std::string> orders(16);
+        std::vector<std::jthread> chiefs;
+        for (int i = 1; i <= 2; ++i) chiefs.emplace_back(chief, i, std::ref(orders));
+        for (std::string dish : { "Pizza", "Pasta", "Salad", "Steak" }) orders.push(dish);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::cout << "Main thread(main chief) : closing the kitchen\n";
+    }
+
+    constexpr int chiefs = 4;
+    std::cout << "\n" << chiefs << " idle chiefs , request_stop() , hardware threads "
+              << std::thread::hardware_concurrency() << "\n";
+    std::cout << "wait\t\t\t\t\tlatency mean / max (us)\tidle CPU (% of a core)\n";
+
+    row("poll stop_requested() , busy\t\t", chiefs, [](std::stop_token stop) {
+        while (!stop.stop_requested()) {
+        }
+    });
+    row("poll stop_requested() , sleep 1ms\t", chiefs, [](std::stop_token stop) {
+        while (!stop.stop_requested()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    row("poll stop_requested() , sleep 10ms\t", chiefs, [](std::stop_token stop) {
+        while (!stop.stop_requested()) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    });
+    row("interruptible_sleep_for(10s)\t\t", chiefs, [](std::stop_token stop) {
+        interruptible_sleep_for(stop, std::chrono::seconds(10));
+    });
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool ordered = false;
+    row("condition_variable , interruptible_wait", chiefs, [&](std::stop_token stop) {
+        std::unique_lock<std::mutex> lock(mtx);
+        interruptible_wait(cv, lock, stop, [&] { return ordered; });
+    });
+
+    std::condition_variable_any cvAny;
+    row("condition_variable_any , wait(stop)\t", chiefs, [&](std::stop_token stop) {
+        std::unique_lock<std::mutex> lock(mtx);
+        cvAny.wait(lock, stop, [&] { return ordered; });
+    });
+
+    mpmc_ring<int> ring(64);
+    row("mpmc_ring::pop(out , stop)\t\t", chiefs, [&](std::stop_token stop) {
+        int order;
+        ring.pop(order, stop);
+    });
+
+    batching_channel<int> channel;
+    row("batching_channel::receive(out , stop)\t", chiefs, [&](std::stop_token stop) {
+        std::vector<int> orders;
+        channel.receive(orders, stop);
+    });
+
+    fair_counting_semaphore<> ovens(0);
+    row("fair_counting_semaphore::acquire(stop)\t", chiefs, [&](std::stop_token stop) { ovens.acquire(stop); });
+
+    //the cancelled waiters left nothing behind : no stale queue entry takes the next item or permit
+    ring.push(1);
+    channel.send(2);
+    ovens.release();
+    std::vector<int> orders;
+    std::cout << "\nafter cancellation : pop " << ring.pop() << " , receive " << channel.receive(orders)
+              << " , try_acquire " << std::boolalpha << ovens.try_acquire() << "\n";
+    return 0;
+}
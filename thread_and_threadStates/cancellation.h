@@ -0,0 +1,66 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stop_token>
+
+/*
+cooperative cancellation : std::jthread + std::stop_token instead of the bool & state of readme.md
+-readme : chief(int , bool & state) , one thread writes a plain bool while another reads it --> a data race (UB) ,
+    and a chief that polls such a flag in a loop burns a core while there is nothing to cook
+-std::jthread passes its own stop_token as the first argument when the function takes one ,
+    ~jthread() = request_stop() + join()
+-polling stop_requested() fixes the race , not the waste : a chief that sleeps or waits must be WOKEN by the stop
+    std::stop_callback runs in the thread that calls request_stop() (or at once , if stop was already requested)
+    and interrupts the wait the chief is in :
+        std::condition_variable + mutex --> interruptible_wait (below)
+        sleeping                        --> interruptible_sleep_for (below)
+        mpmc_ring push / pop            --> push(value , stop) / pop(out , stop)   (condition_variable/mpmc_ring.h)
+        batching_channel receive        --> receive(out , stop)                   (condition_variable/batching_channel.h)
+        fair_counting_semaphore         --> acquire(stop , n)                     (semaphore/fair_semaphore.h)
+-condition_variable_any has wait(lock , stop_token , pred) built in , interruptible_wait is for the
+    std::condition_variable the rest of the repo uses
+    the price : its callback takes the caller's mutex , so request_stop() must not be called with it held
+*/
+
+//true : pred() holds , false : stop was requested first , called and returns with lock held
+//PRECONDITION : no thread calls request_stop() on stop's source while holding lock's mutex
+//    the callback locks that mutex and runs inside request_stop() --> such a thread deadlocks itself
+//    (condition_variable_any::wait(lock , stop , pred) notifies through its own mutex and has no such rule)
+template <typename Predicate>
+bool interruptible_wait(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, std::stop_token stop,
+                        Predicate pred) {
+    if (pred()) return true;
+    if (!stop.stop_possible()) {
+        cv.wait(lock, pred);
+        return true;
+    }
+    std::mutex& mtx{*lock.mutex()};
+    for (;;) {
+        if (stop.stop_requested()) return false;
+        //the callback locks mtx : it is registered and destroyed with the lock RELEASED ,
+        //it may run inside the constructor and ~stop_callback waits for a running one
+        lock.unlock();
+        {
+            std::stop_callback wake{stop, [&cv, &mtx] {
+                std::lock_guard<std::mutex> guard(mtx); //never between the waiter's check and its sleep
+                cv.notify_all();                        //we do not know which waiter is ours
+            }};
+            lock.lock();
+            cv.wait(lock, [&] { return pred() || stop.stop_requested(); });
+            lock.unlock();
+        }
+        lock.lock();
+        if (pred()) return true; //re-checked : it may have changed while the lock was released
+    }
+}
+
+//the sleep of a polling loop , cut short by stop : false when woken early
+template <typename Rep, typename Period>
+bool interruptible_sleep_for(std::stop_token stop, const std::chrono::duration<Rep, Period>& duration) {
+    std::mutex mtx;
+    std::condition_variable_any cv;
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait_for(lock, stop, duration, [] { return false; });
+    return !stop.stop_requested();
+}
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "deadline_scheduler.h"
+
+//g++ -std=c++20 -O2 -pthread deadline_scheduler.cpp -o deadline_scheduler
+
+using Clock = DeadlineScheduler::Clock;
+using namespace std::chrono_literals;
+
+/*
+the Responsive Restaurant at rush hour , 2 chefs :
+-20 steaks ordered at once : 5 ms each , due within 150 ms
+-800 salads , one every 250 us : 0.4 ms each , due within 5 ms
+    --> the salads alone keep both chefs ~80% busy (more with the sleep overshoot)
+cooking is sleep_for , so 2 chefs really are 2 chefs even on one core
+every task measures itself (start - submit , finished after its deadline ?) : the same yardstick for all runs
+*/
+struct Measured {
+    std::mutex mtx;
+    std::vector<double> delays[2]; //0 = salads , 1 = steaks , microseconds
+    int misses[2]{};
+
+    void record(int kind, Clock::time_point submitted, Clock::time_point started, Clock::time_point deadline) {
+        const auto finished = Clock::now();
+        std::lock_guard<std::mutex> lock(mtx);
+        delays[kind].push_back(std::chrono::duration<double, std::micro>(started - submitted).count());
+        if (finished > deadline) ++misses[kind];
+    }
+
+    double percentile(int kind, double p) {
+        auto& d = delays[kind];
+        std::sort(d.begin(), d.end());
+        return d.empty() ? 0.0 : d[static_cast<std::size_t>(p * (d.size() - 1))];
+    }
+};
+
+enum class Policy { Fifo, Edf, EdfAging };
+
+void rushHour(Policy policy, std::chrono::microseconds agingStep, Measured& measured, bool printBuiltIn) {
+    DeadlineScheduler kitchen(2, policy == Policy::EdfAging ? agingStep : 0us);
+    std::vector<std::future<void>> orders;
+
+    auto order = [&](int kind, TaskClass taskClass, std::chrono::microseconds cook, std::chrono::microseconds due) {
+        const auto submitted = Clock::now();
+        const auto deadline = submitted + due;
+        auto dish = [&measured, kind, cook, submitted, deadline] {
+            const auto started = Clock::now();
+            std::this_thread::sleep_for(cook);
+            measured.record(kind, submitted, started, deadline);
+        };
+        if (policy == Policy::Fifo) {
+            orders.push_back(kitchen.submit(TaskClass::Normal, submitted, dish)); //EDF on the submit time = FIFO
+        } else {
+            orders.push_back(kitchen.submit(taskClass, deadline, dish));
+        }
+    };
+
+    for (int i = 0; i < 20; ++i) order(1, TaskClass::Batch, 5ms, 150ms);
+    for (int i = 0; i < 800; ++i) {
+        order(0, TaskClass::Interactive, 400us, 5ms);
+        std::this_thread::sleep_for(250us);
+    }
+    for (auto& o : orders) o.get();
+    if (printBuiltIn) kitchen.printMetrics(std::cout);
+}
+
+int main() {
+    std::cout << "2 chefs , 20 steaks (5 ms , due in 150 ms) , then 800 salads (0.4 ms every 250 us , due in 5 ms)\n";
+    std::cout << "policy\t\t\tsalad misses\tsalad p99 delay\tsteak misses\tsteak max delay (ms)\n";
+    struct Row {
+        const char* name;
+        Policy policy;
+        std::chrono::microseconds agingStep;
+    };
+    for (const Row& row : { Row{ "FIFO (one queue)\t", Policy::Fifo, 0us },
+                            Row{ "classes + EDF\t\t", Policy::Edf, 0us },
+                            Row{ "EDF + aging 50 ms\t", Policy::EdfAging, 50ms },
+                            Row{ "EDF + aging 20 ms\t", Policy::EdfAging, 20ms } }) {
+        Measured m;
+        rushHour(row.policy, row.agingStep, m, false);
+        std::cout << row.name << m.misses[0] << "/" << m.delays[0].size() << "\t\t"
+                  << m.percentile(0, 0.99) / 1000 << " ms\t\t" << m.misses[1] << "/" << m.delays[1].size() << "\t\t"
+                  << m.percentile(1, 1.0) / 1000 << "\n";
+    }
+
+    std::cout << "\nbuilt-in metrics , classes + EDF + aging 20 ms :\n";
+    Measured m;
+    rushHour(Policy::EdfAging, 20ms, m, true);
+    return 0;
+}
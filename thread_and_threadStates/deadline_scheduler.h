@@ -0,0 +1,269 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+DeadlineScheduler : the Responsive Restaurant with a head chef who decides WHICH dish is next
+-priority classes : Interactive (salads) > Normal > Batch (steaks) , a free chef always takes the highest class
+    --> a salad ordered after 50 steaks does not wait for them
+-inside a class : EDF , earliest deadline first
+-aging : a task that has waited agingStep in its class moves up one class (and can move again after another step)
+    a promoted task is ordered in its new class by an AGED deadline : min(its deadline , promotion + agingStep)
+    --> it is due within one more step up there , it does not jump ahead of the tasks that are due sooner
+    (by its real deadline alone , a steak due in 100 ms would lose to every salad due in 5 ms until too late)
+    --> a flood of salads cannot starve the steaks forever , agingStep = 0 turns aging off
+-per class metrics : queueing delay (mean / p99 / max , from submit to start) , deadline misses (finished late) ,
+    promotions by aging
+-one mutex + one condition_variable : picking a task is O(log n) , fine for tasks of microseconds and up
+*/
+
+enum class TaskClass { Interactive = 0, Normal = 1, Batch = 2 };
+
+struct ClassMetrics {
+    std::uint64_t completed{0};
+    std::uint64_t deadlineMisses{0};
+    std::uint64_t promotions{0}; //tasks that LEFT this class by aging
+    double meanDelayMicros{0};
+    double p99DelayMicros{0};    //upper bound of its histogram bucket : at most 12.5 % above the real one
+    double maxDelayMicros{0};
+};
+
+class DeadlineScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::size_t ClassCount{3};
+    //log2 buckets split into SubBuckets linear ones : [0 , 8) us one per us , then 8 per power of two ,
+    //[2^k , 2^(k+1)) in steps of 2^k / 8 --> a bucket is at most 1/8 of its lower bound wide
+    static constexpr std::size_t SubBuckets{8};
+    static constexpr std::size_t HistogramBuckets{SubBuckets * 38};
+
+    explicit DeadlineScheduler(unsigned workers, std::chrono::microseconds agingStep = std::chrono::milliseconds(50))
+        : m_agingStep{agingStep} {
+        for (unsigned i = 0; i < std::max(1u, workers); ++i) {
+            m_workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    //runs what is queued , then joins
+    ~DeadlineScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_stopping = true;
+        }
+        m_cv.notify_all();
+        for (auto& w : m_workers) w.join();
+    }
+
+    DeadlineScheduler(const DeadlineScheduler&) = delete;
+    DeadlineScheduler& operator=(const DeadlineScheduler&) = delete;
+
+    template <typename Fn>
+    auto submit(TaskClass taskClass, Clock::time_point deadline, Fn fn) -> std::future<std::invoke_result_t<Fn&>> {
+        using R = std::invoke_result_t<Fn&>;
+        auto task{std::make_shared<std::packaged_task<R()>>(std::move(fn))};
+        auto future{task->get_future()};
+        auto entry{std::make_unique<Entry>()};
+        entry->run = [task] { (*task)(); };
+        entry->deadline = entry->effectiveDeadline = deadline;
+        entry->originalClass = static_cast<std::size_t>(taskClass);
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            entry->submitted = entry->enteredClass = Clock::now();
+            entry->sequence = m_sequence++;
+            insert(entry.release(), static_cast<std::size_t>(taskClass));
+        }
+        m_cv.notify_one();
+        return future;
+    }
+
+    template <typename Fn>
+    auto submit(TaskClass taskClass, std::chrono::microseconds relativeDeadline, Fn fn) {
+        return submit(taskClass, Clock::now() + relativeDeadline, std::move(fn));
+    }
+
+    ClassMetrics metrics(TaskClass taskClass) const {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        const Stats& s{m_stats[static_cast<std::size_t>(taskClass)]};
+        ClassMetrics m;
+        m.completed = s.completed;
+        m.deadlineMisses = s.misses;
+        m.promotions = s.promotions;
+        m.meanDelayMicros = s.completed == 0 ? 0.0 : s.delaySumMicros / s.completed;
+        m.maxDelayMicros = s.delayMaxMicros;
+        const std::uint64_t rank{s.completed - s.completed / 100}; //the 99th percentile
+        std::uint64_t seen{0};
+        for (std::size_t b = 0; b < s.histogram.size(); ++b) {
+            seen += s.histogram[b];
+            if (seen >= rank && s.completed != 0) {
+                //the top bucket may reach past the largest delay seen
+                m.p99DelayMicros = std::min(static_cast<double>(bucketEnd(b)), s.delayMaxMicros);
+                break;
+            }
+        }
+        return m;
+    }
+
+    void printMetrics(std::ostream& out) const {
+        static const char* const names[ClassCount]{ "interactive", "normal", "batch" };
+        out << "class\t\tdone\tmisses\tpromoted\tdelay mean / p99 / max (us)\n";
+        for (std::size_t c = 0; c < ClassCount; ++c) {
+            const ClassMetrics m{metrics(static_cast<TaskClass>(c))};
+            out << names[c] << "\t" << (c == 1 ? "\t" : "") << m.completed << "\t" << m.deadlineMisses << "\t"
+                << m.promotions << "\t\t" << static_cast<std::int64_t>(m.meanDelayMicros) << " / "
+                << static_cast<std::int64_t>(m.p99DelayMicros) << " / " << static_cast<std::int64_t>(m.maxDelayMicros)
+                << "\n";
+        }
+    }
+
+private:
+    struct Entry {
+        std::function<void()> run;
+        Clock::time_point deadline;
+        Clock::time_point effectiveDeadline; //the EDF key : deadline , pulled in by every promotion
+        Clock::time_point submitted;
+        Clock::time_point enteredClass; //submit time , or the time of the last promotion
+        std::uint64_t sequence{0};      //ties : first come , first served
+        std::size_t originalClass{0};   //metrics are kept per ORIGINAL class
+    };
+
+    struct ByDeadline {
+        bool operator()(const Entry* a, const Entry* b) const {
+            return a->effectiveDeadline != b->effectiveDeadline ? a->effectiveDeadline < b->effectiveDeadline
+                                                                : a->sequence < b->sequence;
+        }
+    };
+
+    struct ByEntered {
+        bool operator()(const Entry* a, const Entry* b) const {
+            return a->enteredClass != b->enteredClass ? a->enteredClass < b->enteredClass : a->sequence < b->sequence;
+        }
+    };
+
+    struct Queue {
+        std::set<Entry*, ByDeadline> byDeadline; //EDF pick
+        std::set<Entry*, ByEntered> byEntered;   //the oldest one , for aging
+    };
+
+    struct Stats {
+        std::uint64_t completed{0};
+        std::uint64_t misses{0};
+        std::uint64_t promotions{0};
+        double delaySumMicros{0};
+        double delayMaxMicros{0};
+        std::array<std::uint64_t, HistogramBuckets> histogram{};
+    };
+
+    void insert(Entry* entry, std::size_t c) {
+        m_queues[c].byDeadline.insert(entry);
+        m_queues[c].byEntered.insert(entry);
+    }
+
+    void erase(Entry* entry, std::size_t c) {
+        m_queues[c].byDeadline.erase(entry);
+        m_queues[c].byEntered.erase(entry);
+    }
+
+    //moves every task that waited agingStep in class c (c > 0) to class c - 1 , oldest first
+    void age(Clock::time_point now) {
+        if (m_agingStep.count() == 0) return;
+        for (std::size_t c = 1; c < ClassCount; ++c) {
+            auto& byEntered{m_queues[c].byEntered};
+            while (!byEntered.empty() && now - (*byEntered.begin())->enteredClass >= m_agingStep) {
+                Entry* entry{*byEntered.begin()};
+                erase(entry, c);
+                entry->enteredClass = now;
+                entry->effectiveDeadline = std::min(entry->effectiveDeadline, now + m_agingStep);
+                insert(entry, c - 1);
+                ++m_stats[c].promotions;
+            }
+        }
+    }
+
+    //highest class first , earliest (aged) deadline inside it , nullptr when everything is empty
+    Entry* pick() {
+        age(Clock::now());
+        for (std::size_t c = 0; c < ClassCount; ++c) {
+            if (!m_queues[c].byDeadline.empty()) {
+                Entry* entry{*m_queues[c].byDeadline.begin()};
+                erase(entry, c);
+                return entry;
+            }
+        }
+        return nullptr;
+    }
+
+    bool empty() const {
+        for (const auto& q : m_queues) {
+            if (!q.byDeadline.empty()) return false;
+        }
+        return true;
+    }
+
+    void workerLoop() {
+        for (;;) {
+            std::unique_ptr<Entry> entry;
+            Clock::time_point started;
+            {
+                std::unique_lock<std::mutex> lock(m_mtx);
+                m_cv.wait(lock, [this] { return !empty() || m_stopping; });
+                entry.reset(pick());
+                if (!entry) return; //stopping and drained
+                started = Clock::now();
+            }
+            entry->run(); //packaged_task keeps the exception for the future
+            const Clock::time_point finished{Clock::now()};
+            record(*entry, started, finished);
+        }
+    }
+
+    static std::size_t bucketOf(std::uint64_t micros) {
+        if (micros < SubBuckets) return static_cast<std::size_t>(micros);
+        const std::size_t power{static_cast<std::size_t>(std::bit_width(micros)) - 1}; //micros in [2^power , 2^(power + 1))
+        const std::size_t sub{static_cast<std::size_t>(micros >> (power - 3)) - SubBuckets}; //SubBuckets == 2^3
+        return std::min(HistogramBuckets - 1, SubBuckets + (power - 3) * SubBuckets + sub);
+    }
+
+    //exclusive upper bound of bucket b in us
+    static std::uint64_t bucketEnd(std::size_t b) {
+        if (b < SubBuckets) return b + 1;
+        const std::size_t power{3 + (b - SubBuckets) / SubBuckets};
+        const std::uint64_t sub{(b - SubBuckets) % SubBuckets};
+        return (SubBuckets + sub + 1) << (power - 3);
+    }
+
+    void record(const Entry& entry, Clock::time_point started, Clock::time_point finished) {
+        const double delay{std::chrono::duration<double, std::micro>(started - entry.submitted).count()};
+        const std::size_t bucket{bucketOf(static_cast<std::uint64_t>(delay))};
+        std::lock_guard<std::mutex> lock(m_mtx);
+        Stats& s{m_stats[entry.originalClass]};
+        ++s.completed;
+        if (finished > entry.deadline) ++s.misses;
+        s.delaySumMicros += delay;
+        s.delayMaxMicros = std::max(s.delayMaxMicros, delay);
+        ++s.histogram[bucket];
+    }
+
+    const std::chrono::microseconds m_agingStep;
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::array<Queue, ClassCount> m_queues;
+    std::array<Stats, ClassCount> m_stats;
+    std::uint64_t m_sequence{0};
+    bool m_stopping{false};
+    std::vector<std::thread> m_workers;
+};
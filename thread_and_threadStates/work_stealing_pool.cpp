@@ -0,0 +1,170 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "work_stealing_pool.h"
+
+//g++ -std=c++20 -O2 -pthread work_stealing_pool.cpp -o work_stealing_pool
+
+//one queue , one mutex , one condition_variable for every worker : the classic pool
+class SharedQueuePool {
+public:
+    explicit SharedQueuePool(unsigned threadCount) {
+        for (unsigned i = 0; i < threadCount; ++i) {
+            m_workers.emplace_back([this] {
+                for (;;) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(m_mtx);
+                        m_cv.wait(lock, [this] { return !m_tasks.empty() || m_stopping; });
+                        if (m_tasks.empty()) return;
+                        task = std::move(m_tasks.front());
+                        m_tasks.pop_front();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    ~SharedQueuePool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_stopping = true;
+        }
+        m_cv.notify_all();
+        for (auto& w : m_workers) w.join();
+    }
+
+    template <typename Fn>
+    auto submit(Fn fn) -> std::future<std::invoke_result_t<Fn&>> {
+        using R = std::invoke_result_t<Fn&>;
+        auto task{std::make_shared<std::packaged_task<R()>>(std::move(fn))}; //std::function wants copyable
+        auto future{task->get_future()};
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_tasks.emplace_back([task] { (*task)(); });
+        }
+        m_cv.notify_one();
+        return future;
+    }
+
+private:
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::deque<std::function<void()>> m_tasks;
+    bool m_stopping{false};
+    std::vector<std::thread> m_workers;
+};
+
+//a short dish : about a microsecond of arithmetic
+std::uint64_t prepareDish(std::uint64_t seed) {
+    std::uint64_t x{seed | 1};
+    for (int i = 0; i < 300; ++i) x = x * 6364136223846793005ull + 1442695040888963407ull;
+    return x >> 60;
+}
+
+template <typename Body>
+double millionTasksPerSecond(int tasks, Body body) {
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    return tasks / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / 1e6;
+}
+
+//iterative below the cut-off , plus some work so that a leaf is worth a task
+std::uint64_t fibLeaf(int n) {
+    std::uint64_t a{0}, b{1};
+    for (int i = 0; i < n; ++i) b = std::exchange(a, b) + b;
+    volatile std::uint64_t burn{0};
+    for (int i = 0; i < 20000; ++i) burn = burn + i;
+    return a;
+}
+
+std::uint64_t fibSequential(int n) {
+    return n < 20 ? fibLeaf(n) : fibSequential(n - 1) + fibSequential(n - 2);
+}
+
+//nested : every call spawns its left half as a task and waits for it (helping) , cut-off at n < 20
+std::uint64_t fib(WorkStealingPool& pool, int n) {
+    if (n < 20) return fibLeaf(n);
+    auto left{pool.submit([&pool, n] { return fib(pool, n - 1); })};
+    const std::uint64_t right{fib(pool, n - 2)};
+    return pool.get(left) + right;
+}
+
+int main() {
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+    //the Responsive Restaurant of readme.md , with a fixed team of chefs
+    {
+        WorkStealingPool kitchen(threads);
+        std::vector<std::future<std::string>> dishes;
+        for (std::string dish : { "Pizza", "Pasta", "Salad", "Steak" }) {
+            dishes.push_back(kitchen.submit([dish] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100)); //time to prepare
+                return dish + " is ready!";
+            }));
+        }
+        for (auto& d : dishes) std::cout << d.get() << "\n";
+    }
+
+    constexpr int tasks = 20'000;
+    std::cout << "\n" << tasks << " short tasks (~1us) , " << threads << " worker(s) , million tasks / s\n";
+    std::atomic<std::uint64_t> total{0};
+
+    const double perTask = millionTasksPerSecond(tasks, [&] {
+        std::vector<std::thread> chefs; //readme : chefs.emplace_back(prepare_dish , dish)
+        chefs.reserve(tasks);
+        for (int i = 0; i < tasks; ++i) chefs.emplace_back([&total, i] { total += prepareDish(i); });
+        for (auto& chef : chefs) chef.join();
+    });
+    std::cout << "thread per task\t\t\t" << perTask << "\n";
+
+    SharedQueuePool shared(threads);
+    const double sharedQueue = millionTasksPerSecond(tasks, [&] {
+        std::vector<std::future<void>> futures;
+        futures.reserve(tasks);
+        for (int i = 0; i < tasks; ++i) futures.push_back(shared.submit([&total, i] { total += prepareDish(i); }));
+        for (auto& f : futures) f.get();
+    });
+    std::cout << "shared-queue pool , submit\t" << sharedQueue << "\n";
+
+    WorkStealingPool pool(threads);
+    const double stealing = millionTasksPerSecond(tasks, [&] {
+        std::vector<std::future<void>> futures;
+        futures.reserve(tasks);
+        for (int i = 0; i < tasks; ++i) futures.push_back(pool.submit([&total, i] { total += prepareDish(i); }));
+        for (auto& f : futures) pool.get(f);
+    });
+    std::cout << "work-stealing pool , submit\t" << stealing << "\n";
+
+    const double parallelFor = millionTasksPerSecond(tasks, [&] {
+        pool.parallel_for(0, tasks, 64, [&total](int i) { total += prepareDish(i); });
+    });
+    std::cout << "work-stealing , parallel_for 64\t" << parallelFor << "\n";
+
+    //nested tasks : a worker waits for its own children without blocking the pool
+    for (int n : { 25, 28 }) {
+        const auto start = std::chrono::steady_clock::now();
+        auto root{pool.submit([&pool, n] { return fib(pool, n); })};
+        const std::uint64_t result{pool.get(root)};
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        const auto sequentialStart = std::chrono::steady_clock::now();
+        const bool same{fibSequential(n) == result};
+        const double sequentialMs =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sequentialStart).count();
+        std::cout << "nested fib(" << n << ") = " << result << " in " << ms << " ms , sequential " << sequentialMs
+                  << " ms , same result " << std::boolalpha << same << "\n";
+    }
+    std::cout << "(checksum " << total.load() << ")\n";
+    return 0;
+}
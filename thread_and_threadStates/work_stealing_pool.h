@@ -0,0 +1,339 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <linux/futex.h>
+#include <memory>
+#include <mutex>
+#include <sys/syscall.h>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/*
+WorkStealingPool : a fixed team of chefs instead of one std::thread per dish (prepare_dish of readme.md)
+-N worker threads , created once , each with its OWN Chase-Lev deque of tasks :
+    the owner pushes and pops at the bottom (LIFO , cache-warm , no CAS unless one task is left)
+    idle workers steal from the top of a random victim (FIFO , the oldest = usually the biggest piece of work)
+-submit(fn) --> std::future
+    from a worker (nested task)  : onto that worker's own deque , no lock
+    from any other thread        : onto the shared injection queue (mutex) , workers drain it before stealing
+-parallel_for(begin , end , grain , fn) : splits the range in halves , pushes one half as a task , keeps the other
+    --> thieves take big halves , the owner works down to pieces of `grain`
+-get(future) / parallel_for never just block : the waiting thread runs other tasks until its work is done
+    (a worker that blocked in future::get() on a nested task could deadlock a full pool)
+-idle workers park on a futex (Linux only) :
+    worker : ++m_sleepers ; fence ; ticket = m_epoch ; look for work again ; FUTEX_WAIT(m_epoch , ticket)
+    submit : push ; fence ; if m_sleepers != 0 --> --m_sleepers , ++m_epoch , FUTEX_WAKE 1
+    the submitter takes the registration --> a burst of N submits wakes N different sleepers , not 1 N times
+-the destructor runs every queued task , then joins
+*/
+
+namespace ws_detail {
+    inline void futexWait(std::atomic<std::uint32_t>& word, std::uint32_t expected) {
+        static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+    }
+
+    inline void futexWake(std::atomic<std::uint32_t>& word, int count) {
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+    }
+
+    struct Task {
+        virtual ~Task() = default;
+        virtual void run() = 0;
+    };
+
+    template <typename Fn>
+    struct FnTask final : Task {
+        explicit FnTask(Fn f) : fn{std::move(f)} {}
+        void run() override { fn(); }
+        Fn fn;
+    };
+
+    //Chase & Lev , "Dynamic Circular Work-Stealing Deque" , memory orders of Le et al. (PPoPP 2013)
+    //push / pop : owner thread only , steal : any thread
+    class ChaseLevDeque {
+    public:
+        explicit ChaseLevDeque(std::int64_t capacity = 256) : m_array{new Array(capacity)} { m_arrays.emplace_back(m_array.load()); }
+
+        ChaseLevDeque(const ChaseLevDeque&) = delete;
+        ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+        void push(Task* task) {
+            const std::int64_t b{m_bottom.load(std::memory_order_relaxed)};
+            const std::int64_t t{m_top.load(std::memory_order_acquire)};
+            Array* a{m_array.load(std::memory_order_relaxed)};
+            if (b - t > a->capacity - 1) a = grow(a, t, b);
+            a->put(b, task);
+            m_bottom.store(b + 1, std::memory_order_release);
+        }
+
+        Task* pop() {
+            const std::int64_t b{m_bottom.load(std::memory_order_relaxed) - 1};
+            Array* a{m_array.load(std::memory_order_relaxed)};
+            m_bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t t{m_top.load(std::memory_order_relaxed)};
+            if (t > b) { //empty
+                m_bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            Task* task{a->get(b)};
+            if (t == b) { //the last one : race the thieves for it
+                if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    task = nullptr;
+                }
+                m_bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return task;
+        }
+
+        Task* steal() {
+            std::int64_t t{m_top.load(std::memory_order_acquire)};
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::int64_t b{m_bottom.load(std::memory_order_acquire)};
+            if (t >= b) return nullptr;
+            Array* a{m_array.load(std::memory_order_acquire)};
+            Task* task{a->get(t)};
+            if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return nullptr; //lost to the owner or another thief
+            }
+            return task;
+        }
+
+        bool empty() const {
+            return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct Array {
+            explicit Array(std::int64_t n) : capacity{n}, mask{n - 1}, slots{new std::atomic<Task*>[n]} {}
+            Task* get(std::int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+            void put(std::int64_t i, Task* task) { slots[i & mask].store(task, std::memory_order_relaxed); }
+            const std::int64_t capacity;
+            const std::int64_t mask;
+            std::unique_ptr<std::atomic<Task*>[]> slots;
+        };
+
+        //owner only , old arrays stay alive until the deque dies : a thief may still read one
+        Array* grow(Array* old, std::int64_t t, std::int64_t b) {
+            auto bigger{std::make_unique<Array>(old->capacity * 2)};
+            for (std::int64_t i = t; i < b; ++i) bigger->put(i, old->get(i));
+            Array* raw{bigger.get()};
+            m_arrays.push_back(std::move(bigger));
+            m_array.store(raw, std::memory_order_release);
+            return raw;
+        }
+
+        alignas(64) std::atomic<std::int64_t> m_top{0};      //thieves
+        alignas(64) std::atomic<std::int64_t> m_bottom{0};   //owner
+        std::atomic<Array*> m_array;
+        std::vector<std::unique_ptr<Array>> m_arrays;
+    };
+}
+
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threadCount = std::max(1u, std::thread::hardware_concurrency()))
+        : m_workers(std::max(1u, threadCount)) {
+        for (std::size_t i = 0; i < m_workers.size(); ++i) {
+            m_workers[i].thread = std::thread([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        m_stopping.store(true, std::memory_order_seq_cst);
+        m_epoch.fetch_add(1, std::memory_order_release);
+        ws_detail::futexWake(m_epoch, INT_MAX);
+        for (auto& w : m_workers) w.thread.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    std::size_t size() const noexcept { return m_workers.size(); }
+
+    template <typename Fn>
+    auto submit(Fn fn) -> std::future<std::invoke_result_t<Fn&>> {
+        using R = std::invoke_result_t<Fn&>;
+        std::packaged_task<R()> task(std::move(fn));
+        auto future{task.get_future()};
+        enqueue(new ws_detail::FnTask<std::packaged_task<R()>>(std::move(task)));
+        return future;
+    }
+
+    //waits for the future , running other tasks meanwhile (safe inside a task)
+    template <typename R>
+    R get(std::future<R>& future) {
+        helpUntil([&] { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+        return future.get();
+    }
+
+    //fn(i) for every i in [begin , end) , pieces of at most grain indices , rethrows the first exception
+    template <typename Index, typename Fn>
+    void parallel_for(Index begin, Index end, Index grain, Fn fn) {
+        if (!(begin < end)) return;
+        ForState state;
+        state.pending.store(1, std::memory_order_relaxed);
+        split(begin, end, std::max<Index>(1, grain), fn, state);
+        helpUntil([&] { return state.pending.load(std::memory_order_acquire) == 0; });
+        if (state.error) std::rethrow_exception(state.error);
+    }
+
+private:
+    struct alignas(64) Worker {
+        ws_detail::ChaseLevDeque deque;
+        std::thread thread;
+    };
+
+    struct ForState {
+        std::atomic<std::int64_t> pending{0};
+        std::mutex errorMtx;
+        std::exception_ptr error;
+    };
+
+    struct CurrentWorker {
+        const WorkStealingPool* pool{nullptr};
+        std::size_t index{0};
+        std::uint64_t rng{0x9e3779b97f4a7c15ull};
+    };
+
+    static CurrentWorker& current() {
+        thread_local CurrentWorker worker;
+        return worker;
+    }
+
+    //the range owner keeps the left half , the right half becomes a task for thieves
+    template <typename Index, typename Fn>
+    void split(Index begin, Index end, Index grain, Fn& fn, ForState& state) {
+        while (end - begin > grain) {
+            const Index middle{begin + (end - begin) / 2};
+            state.pending.fetch_add(1, std::memory_order_relaxed);
+            enqueue(new ws_detail::FnTask([this, middle, end, grain, &fn, &state] { split(middle, end, grain, fn, state); }));
+            end = middle;
+        }
+        try {
+            for (Index i = begin; i < end; ++i) fn(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(state.errorMtx);
+            if (!state.error) state.error = std::current_exception();
+        }
+        state.pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    void enqueue(ws_detail::Task* task) {
+        CurrentWorker& self{current()};
+        if (self.pool == this) {
+            m_workers[self.index].deque.push(task);
+        } else {
+            std::lock_guard<std::mutex> lock(m_injectMtx);
+            m_injected.push_back(task);
+            m_injectedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        wakeOne();
+    }
+
+    //own deque , then the injection queue , then a random victim
+    ws_detail::Task* findTask() {
+        CurrentWorker& self{current()};
+        const bool isWorker{self.pool == this};
+        if (isWorker) {
+            if (ws_detail::Task* task = m_workers[self.index].deque.pop()) return task;
+        }
+        if (m_injectedCount.load(std::memory_order_relaxed) != 0) {
+            std::lock_guard<std::mutex> lock(m_injectMtx);
+            if (!m_injected.empty()) {
+                ws_detail::Task* task{m_injected.front()};
+                m_injected.pop_front();
+                m_injectedCount.fetch_sub(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+        const std::size_t n{m_workers.size()};
+        self.rng ^= self.rng << 13;
+        self.rng ^= self.rng >> 7;
+        self.rng ^= self.rng << 17;
+        const std::size_t start{static_cast<std::size_t>(self.rng % n)};
+        for (std::size_t k = 0; k < n; ++k) {
+            const std::size_t victim{(start + k) % n};
+            if (isWorker && victim == self.index) continue;
+            if (ws_detail::Task* task = m_workers[victim].deque.steal()) return task;
+        }
+        return nullptr;
+    }
+
+    bool runOne() {
+        ws_detail::Task* task{findTask()};
+        if (task == nullptr) return false;
+        task->run(); //packaged_task / split catch their exceptions
+        delete task;
+        return true;
+    }
+
+    template <typename Done>
+    void helpUntil(Done done) {
+        while (!done()) {
+            if (!runOne()) std::this_thread::yield(); //the rest is running elsewhere
+        }
+    }
+
+    bool anyWork() const {
+        if (m_injectedCount.load(std::memory_order_relaxed) != 0) return true;
+        for (const auto& w : m_workers) {
+            if (!w.deque.empty()) return true;
+        }
+        return false;
+    }
+
+    void workerLoop(std::size_t index) {
+        current() = CurrentWorker{ this, index, 0x9e3779b97f4a7c15ull * (index + 1) };
+        for (;;) {
+            if (runOne()) continue;
+            m_sleepers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::uint32_t ticket{m_epoch.load(std::memory_order_acquire)};
+            if (anyWork()) {
+                takeSleeper();
+                continue;
+            }
+            if (m_stopping.load(std::memory_order_acquire)) {
+                takeSleeper();
+                return;
+            }
+            ws_detail::futexWait(m_epoch, ticket);
+        }
+    }
+
+    bool takeSleeper() {
+        for (std::uint32_t n{m_sleepers.load(std::memory_order_relaxed)}; n != 0;) {
+            if (m_sleepers.compare_exchange_weak(n, n - 1, std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+
+    void wakeOne() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleepers.load(std::memory_order_relaxed) != 0 && takeSleeper()) {
+            m_epoch.fetch_add(1, std::memory_order_release);
+            ws_detail::futexWake(m_epoch, 1);
+        }
+    }
+
+    std::vector<Worker> m_workers;
+    std::mutex m_injectMtx;
+    std::deque<ws_detail::Task*> m_injected;
+    alignas(64) std::atomic<std::size_t> m_injectedCount{0};
+    alignas(64) std::atomic<std::uint32_t> m_sleepers{0};
+    std::atomic<std::uint32_t> m_epoch{0};
+    std::atomic<bool> m_stopping{false};
+};
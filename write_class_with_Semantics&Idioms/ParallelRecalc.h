@@ -0,0 +1,147 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "RecalcEngine.h"
+
+/*
+-full recalculation on all cores :
+    1-RecalcEngine::topologicalLevels() splits the DAG into levels , cells of one level are independent
+    2-each level is cut into chunks , every worker owns a contiguous run of chunks (locality)
+    3-a worker that finished its own run steals chunks from the others (work stealing)
+    4-std::barrier between levels : level n+1 starts only when level n is completely written
+-an exception in a worker (a jthread would call std::terminate) is caught , the other workers stop taking chunks ,
+    every worker still arrives at the barrier (no one is left waiting) , the completion function skips the
+    remaining levels and recalculateAll() rethrows the first exception on the calling thread after the join
+-every cell is evaluated by exactly the same code as the serial version --> identical results
+*/
+
+class ParallelRecalculator {
+public:
+    ParallelRecalculator(RecalcEngine& engine, unsigned threadCount)
+        : m_engine{engine}, m_threadCount{std::max(1u, threadCount)} {}
+
+    void recalculateAll();
+
+private:
+    //one per worker , on its own cache line : stealing touches only the victim's line
+    struct alignas(64) ChunkRange {
+        std::atomic<std::size_t> next{0};
+        std::size_t end{0};
+    };
+
+    void prepareLevel(std::size_t level);
+    void runLevel(unsigned id);
+    void evaluateChunk(std::size_t chunk);
+    bool takeChunk(ChunkRange& range, std::size_t& chunk);
+    void fail(std::exception_ptr error) noexcept;
+
+    RecalcEngine& m_engine;
+    unsigned m_threadCount;
+    std::vector<std::vector<LeveledFormula>> m_levels;
+    std::unique_ptr<ChunkRange[]> m_ranges;
+    std::size_t m_level{0};
+    std::size_t m_chunkSize{1};
+    std::atomic<bool> m_failed{false};
+    std::exception_ptr m_error; //written by the first worker that failed , read after the join
+};
+
+inline void ParallelRecalculator::prepareLevel(std::size_t level) {
+    m_level = level;
+    if (level >= m_levels.size()) {
+        return;
+    }
+    const std::size_t cells{m_levels[level].size()};
+    //~8 chunks per worker : enough to balance , big enough to amortize the atomic
+    m_chunkSize = std::max<std::size_t>(64, cells / (m_threadCount * 8));
+    const std::size_t chunks{(cells + m_chunkSize - 1) / m_chunkSize};
+    const std::size_t perWorker{(chunks + m_threadCount - 1) / m_threadCount};
+    for (unsigned id = 0; id < m_threadCount; ++id) {
+        const std::size_t begin{std::min(chunks, id * perWorker)};
+        m_ranges[id].next.store(begin, std::memory_order_relaxed);
+        m_ranges[id].end = std::min(chunks, begin + perWorker);
+    }
+}
+
+inline bool ParallelRecalculator::takeChunk(ChunkRange& range, std::size_t& chunk) {
+    if (range.next.load(std::memory_order_relaxed) >= range.end || m_failed.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    chunk = range.next.fetch_add(1, std::memory_order_relaxed);
+    return chunk < range.end;
+}
+
+inline void ParallelRecalculator::evaluateChunk(std::size_t chunk) {
+    const auto& level{m_levels[m_level]};
+    Spreadsheet& sheet{m_engine.getSheet()};
+    const std::size_t end{std::min(level.size(), (chunk + 1) * m_chunkSize)};
+    for (std::size_t i = chunk * m_chunkSize; i < end; ++i) {
+        //cells of one level are distinct and read only earlier levels : no data race
+        sheet.setCellAt(level[i].cell.x, level[i].cell.y, level[i].formula->evaluate(sheet));
+    }
+}
+
+inline void ParallelRecalculator::runLevel(unsigned id) {
+    std::size_t chunk{0};
+    while (takeChunk(m_ranges[id], chunk)) {
+        evaluateChunk(chunk);
+    }
+    for (unsigned offset = 1; offset < m_threadCount; ++offset) {
+        ChunkRange& victim{m_ranges[(id + offset) % m_threadCount]};
+        while (takeChunk(victim, chunk)) {
+            evaluateChunk(chunk);
+        }
+    }
+}
+
+inline void ParallelRecalculator::fail(std::exception_ptr error) noexcept {
+    if (!m_failed.exchange(true, std::memory_order_relaxed)) {
+        m_error = std::move(error);
+    }
+}
+
+inline void ParallelRecalculator::recalculateAll() {
+    m_levels = m_engine.topologicalLevels();
+    if (m_levels.empty()) {
+        return;
+    }
+    m_engine.getSheet().cells(); //a read-only view is copied here , not by racing workers
+    m_ranges = std::make_unique<ChunkRange[]>(m_threadCount);
+    m_failed.store(false, std::memory_order_relaxed);
+    m_error = nullptr;
+    prepareLevel(0);
+
+    //the completion function runs once per phase , after every worker arrived and before any is released
+    //a failed level ends the run : the levels after it would read its unwritten cells
+    std::barrier levelDone(static_cast<std::ptrdiff_t>(m_threadCount), [this]() noexcept {
+        prepareLevel(m_failed.load(std::memory_order_relaxed) ? m_levels.size() : m_level + 1);
+    });
+    auto worker = [&](unsigned id) noexcept {
+        while (m_level < m_levels.size()) {
+            try {
+                runLevel(id);
+            } catch (...) {
+                fail(std::current_exception());
+            }
+            levelDone.arrive_and_wait();
+        }
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(m_threadCount - 1);
+        for (unsigned id = 1; id < m_threadCount; ++id) {
+            workers.emplace_back(worker, id);
+        }
+        worker(0); //the calling thread is worker 0
+    } //join
+    if (m_error) {
+        std::rethrow_exception(std::exchange(m_error, nullptr));
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+MyString and Person from "The code" in readme.md , without the tracing output
+(they are stored by the million in SlotMap and serialized by PersonBuffer)
+-value-passing semantics in the constructors
+-unified assignment operator (copy-and-swap)
+*/
+
+class MyString {
+public:
+    MyString() = default;
+    MyString(std::string name) : m_name(std::move(name)) {}
+    MyString(const char* name) : m_name(name) {}
+
+    const std::string& getName() const { return m_name; }
+
+private:
+    std::string m_name{};
+};
+
+class Person {
+public:
+    Person() = default;
+    Person(int id, std::string name) : mId{id}, mName{std::move(name)} {}
+    Person(const Person& rhs) = default;
+    Person(Person&& rhs) noexcept : mId{rhs.mId}, mName{std::move(rhs.mName)}, mFriends{std::move(rhs.mFriends)} {
+        rhs.mId = 0;
+    }
+    Person& operator=(Person rhs) noexcept {
+        swap(*this, rhs);
+        return *this;
+    }
+
+    int getId() const { return mId; }
+    const std::string& getName() const { return mName; }
+    const std::vector<MyString>& getFriends() const { return mFriends; }
+
+    void printData(std::ostream& os = std::cout) const {
+        os << "Id    :" << mId << '\n';
+        os << "Name  :" << mName << '\n';
+        for (const auto& myFriend : mFriends) {
+            os << "Friend:" << myFriend.getName() << '\n';
+        }
+    }
+
+    void addFriendByVlaueMove(MyString myFriend) {
+        mFriends.push_back(std::move(myFriend));
+    }
+    template <typename... U>
+    void addFriendByUnvRef(U&&... myFriend) {
+        (mFriends.emplace_back(std::forward<U>(myFriend)), ...);
+    }
+
+    friend void swap(Person& lhs, Person& rhs) noexcept {
+        std::swap(lhs.mId, rhs.mId);
+        std::swap(lhs.mName, rhs.mName);
+        std::swap(lhs.mFriends, rhs.mFriends);
+    }
+
+private:
+    int mId{};
+    std::string mName{};
+    std::vector<MyString> mFriends{};
+};
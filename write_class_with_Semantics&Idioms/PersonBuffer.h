@@ -0,0 +1,237 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "Person.h"
+
+/*
+Zero-copy binary layout for Person records , version 1 , little-endian , one contiguous buffer :
+
+    | PersonBufferHeader                                                     |
+    | PersonRecord[personCount]  : mId , name ref , first friend , friend count |
+    | StringRef[friendCount]     : every mFriends entry of every Person      |
+    | char[stringsSize]          : string table (optionally each distinct string once) |
+
+-every offset is RELATIVE to the start of its own section , so a buffer can be copied , sent
+    to another process or mapped at any address
+-PersonBufferBuilder appends Persons and returns the whole buffer from finish()
+-PersonBufferView reads fields in place : name() and friendName() return std::string_view
+    into the buffer , no allocation and no parsing , bounds are checked once in the constructor
+*/
+
+struct PersonBufferHeader {
+    char magic[4];           //"PRSN"
+    std::uint32_t version;
+    std::uint32_t personCount;
+    std::uint32_t friendCount;
+    std::uint32_t stringsSize;
+    std::uint32_t reserved;
+};
+
+struct StringRef {
+    std::uint32_t offset; //into the string table
+    std::uint32_t length;
+};
+
+struct PersonRecord {
+    std::int32_t id;
+    StringRef name;
+    std::uint32_t firstFriend; //into the StringRef section
+    std::uint32_t friendCount;
+};
+
+static_assert(std::is_trivially_copyable_v<PersonBufferHeader> && sizeof(PersonBufferHeader) == 24);
+static_assert(std::is_trivially_copyable_v<PersonRecord> && sizeof(PersonRecord) == 20);
+
+inline constexpr char PersonBufferMagic[4]{ 'P', 'R', 'S', 'N' };
+inline constexpr std::uint32_t PersonBufferVersion{1};
+
+class PersonBufferBuilder {
+public:
+    //deduplication makes the buffer smaller when names repeat , but costs a hash lookup per string
+    explicit PersonBufferBuilder(bool deduplicateStrings = false) : m_deduplicate{deduplicateStrings} {}
+
+    void reserve(std::size_t persons, std::size_t stringBytes);
+    void add(const Person& person);
+    //the finished buffer , the builder is empty afterwards
+    std::vector<std::byte> finish();
+
+private:
+    StringRef intern(std::string_view text);
+
+    std::vector<PersonRecord> m_records;
+    std::vector<StringRef> m_friends;
+    std::string m_strings;
+    //repeated names are stored once : hash of the text --> its place in m_strings
+    //(keys are hashes , not views , because m_strings reallocates while it grows)
+    std::unordered_multimap<std::size_t, StringRef> m_interned;
+    bool m_deduplicate;
+};
+
+class PersonView {
+public:
+    std::int32_t id() const { return m_record->id; }
+    std::string_view name() const { return text(m_record->name); }
+    std::size_t friendCount() const { return m_record->friendCount; }
+    std::string_view friendName(std::size_t i) const;
+
+    //the only place that allocates : builds a real Person
+    Person toPerson() const;
+
+private:
+    friend class PersonBufferView;
+    PersonView(const PersonRecord* record, const StringRef* friends, const char* strings)
+        : m_record{record}, m_friends{friends}, m_strings{strings} {}
+    std::string_view text(StringRef ref) const { return { m_strings + ref.offset, ref.length }; }
+
+    const PersonRecord* m_record;
+    const StringRef* m_friends;
+    const char* m_strings;
+};
+
+class PersonBufferView {
+public:
+    //the bytes must outlive the view (a vector , a received message or an mmap)
+    explicit PersonBufferView(std::span<const std::byte> bytes);
+
+    std::size_t size() const { return m_header->personCount; }
+    PersonView operator[](std::size_t i) const { return { m_records + i, m_friends, m_strings }; }
+    PersonView at(std::size_t i) const;
+
+private:
+    const PersonBufferHeader* m_header{nullptr};
+    const PersonRecord* m_records{nullptr};
+    const StringRef* m_friends{nullptr};
+    const char* m_strings{nullptr};
+};
+
+inline void PersonBufferBuilder::reserve(std::size_t persons, std::size_t stringBytes) {
+    m_records.reserve(persons);
+    m_strings.reserve(stringBytes);
+    if (m_deduplicate) {
+        m_interned.reserve(persons);
+    }
+}
+
+inline StringRef PersonBufferBuilder::intern(std::string_view text) {
+    const std::size_t hash{m_deduplicate ? std::hash<std::string_view>{}(text) : 0};
+    if (m_deduplicate) {
+        for (auto [it, end] = m_interned.equal_range(hash); it != end; ++it) {
+            if (std::string_view{m_strings.data() + it->second.offset, it->second.length} == text) {
+                return it->second;
+            }
+        }
+    }
+    if (m_strings.size() + text.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error{"PersonBuffer string table is full"};
+    }
+    const StringRef ref{ static_cast<std::uint32_t>(m_strings.size()), static_cast<std::uint32_t>(text.size()) };
+    m_strings += text;
+    if (m_deduplicate) {
+        m_interned.emplace(hash, ref);
+    }
+    return ref;
+}
+
+inline void PersonBufferBuilder::add(const Person& person) {
+    PersonRecord record{};
+    record.id = person.getId();
+    record.name = intern(person.getName());
+    record.firstFriend = static_cast<std::uint32_t>(m_friends.size());
+    record.friendCount = static_cast<std::uint32_t>(person.getFriends().size());
+    for (const auto& myFriend : person.getFriends()) {
+        m_friends.push_back(intern(myFriend.getName()));
+    }
+    m_records.push_back(record);
+}
+
+inline std::vector<std::byte> PersonBufferBuilder::finish() {
+    PersonBufferHeader header{};
+    std::memcpy(header.magic, PersonBufferMagic, sizeof(header.magic));
+    header.version = PersonBufferVersion;
+    header.personCount = static_cast<std::uint32_t>(m_records.size());
+    header.friendCount = static_cast<std::uint32_t>(m_friends.size());
+    header.stringsSize = static_cast<std::uint32_t>(m_strings.size());
+
+    const std::size_t recordBytes{m_records.size() * sizeof(PersonRecord)};
+    const std::size_t friendBytes{m_friends.size() * sizeof(StringRef)};
+    std::vector<std::byte> buffer(sizeof(header) + recordBytes + friendBytes + m_strings.size());
+    std::byte* out{buffer.data()};
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    std::memcpy(out, m_records.data(), recordBytes);
+    out += recordBytes;
+    std::memcpy(out, m_friends.data(), friendBytes);
+    out += friendBytes;
+    std::memcpy(out, m_strings.data(), m_strings.size());
+
+    *this = PersonBufferBuilder{m_deduplicate};
+    return buffer;
+}
+
+inline PersonBufferView::PersonBufferView(std::span<const std::byte> bytes) {
+    if (bytes.size() < sizeof(PersonBufferHeader)) {
+        throw std::invalid_argument{"buffer too small for a PersonBuffer header"};
+    }
+    if (reinterpret_cast<std::uintptr_t>(bytes.data()) % alignof(PersonRecord) != 0) {
+        throw std::invalid_argument{"PersonBuffer must be 4-byte aligned to be read in place"};
+    }
+    m_header = reinterpret_cast<const PersonBufferHeader*>(bytes.data());
+    if (std::memcmp(m_header->magic, PersonBufferMagic, sizeof(m_header->magic)) != 0 ||
+        m_header->version != PersonBufferVersion) {
+        throw std::invalid_argument{"not a version 1 PersonBuffer"};
+    }
+    const std::uint64_t recordBytes{std::uint64_t{m_header->personCount} * sizeof(PersonRecord)};
+    const std::uint64_t friendBytes{std::uint64_t{m_header->friendCount} * sizeof(StringRef)};
+    if (sizeof(PersonBufferHeader) + recordBytes + friendBytes + m_header->stringsSize > bytes.size()) {
+        throw std::invalid_argument{"truncated PersonBuffer"};
+    }
+    m_records = reinterpret_cast<const PersonRecord*>(bytes.data() + sizeof(PersonBufferHeader));
+    m_friends = reinterpret_cast<const StringRef*>(bytes.data() + sizeof(PersonBufferHeader) + recordBytes);
+    m_strings = reinterpret_cast<const char*>(bytes.data() + sizeof(PersonBufferHeader) + recordBytes + friendBytes);
+
+    //validate every reference once , so the accessors need no checks
+    auto valid = [this](StringRef ref) {
+        return std::uint64_t{ref.offset} + ref.length <= m_header->stringsSize;
+    };
+    for (std::uint32_t i = 0; i < m_header->friendCount; ++i) {
+        if (!valid(m_friends[i])) throw std::invalid_argument{"corrupt PersonBuffer friend reference"};
+    }
+    for (std::uint32_t i = 0; i < m_header->personCount; ++i) {
+        const PersonRecord& record{m_records[i]};
+        if (!valid(record.name) || std::uint64_t{record.firstFriend} + record.friendCount > m_header->friendCount) {
+            throw std::invalid_argument{"corrupt PersonBuffer record " + std::to_string(i)};
+        }
+    }
+}
+
+inline PersonView PersonBufferView::at(std::size_t i) const {
+    if (i >= size()) {
+        throw std::out_of_range{"PersonBuffer index out of range"};
+    }
+    return (*this)[i];
+}
+
+inline std::string_view PersonView::friendName(std::size_t i) const {
+    if (i >= friendCount()) {
+        throw std::out_of_range{"friend index out of range"};
+    }
+    return text(m_friends[m_record->firstFriend + i]);
+}
+
+inline Person PersonView::toPerson() const {
+    Person person{id(), std::string{name()}};
+    for (std::size_t i = 0; i < friendCount(); ++i) {
+        person.addFriendByVlaueMove(MyString{std::string{friendName(i)}});
+    }
+    return person;
+}
@@ -0,0 +1,463 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Spreadsheet.h"
+
+/*
+-Formula cells : "=SUM(A1:A10,C3)" , "=PRODUCT(...)" , "=MIN(...)" , "=MAX(...)" , "=AVERAGE(...)" , "=B2"
+-BasicRecalcEngine<Sheet> keeps a dependency graph : input cell --> formula cells that read it (dependents)
+-editing a cell :
+    1-mark the transitive dependents dirty (DFS , dirty bit = epoch stamp , nothing to clear afterwards)
+    2-the reverse post-order of that DFS is a topological order of the dirty cells
+    3-recompute only those cells , each exactly once
+-a formula that would close a cycle is rejected with CycleError , which lists the offending cells
+*/
+
+struct CellRef {
+    std::size_t x{0};
+    std::size_t y{0};
+};
+
+//A1 --> {0 , 0} , AB12 --> {27 , 11}
+inline CellRef parseCellName(std::string_view name) {
+    std::size_t pos{0};
+    std::size_t column{0};
+    while (pos < name.size() && std::isalpha(static_cast<unsigned char>(name[pos]))) {
+        column = column * 26 + (std::toupper(static_cast<unsigned char>(name[pos])) - 'A' + 1);
+        ++pos;
+    }
+    std::size_t row{0};
+    const std::size_t digitsBegin{pos};
+    while (pos < name.size() && std::isdigit(static_cast<unsigned char>(name[pos]))) {
+        row = row * 10 + (name[pos] - '0');
+        ++pos;
+    }
+    if (column == 0 || pos == digitsBegin || pos != name.size() || row == 0) {
+        throw std::invalid_argument{"invalid cell name: " + std::string{name}};
+    }
+    return { column - 1, row - 1 };
+}
+
+inline std::string cellName(CellRef cell) {
+    std::string column;
+    for (std::size_t n = cell.x + 1; n > 0; n = (n - 1) / 26) {
+        column.insert(column.begin(), static_cast<char>('A' + (n - 1) % 26));
+    }
+    return column + std::to_string(cell.y + 1);
+}
+
+enum class FormulaOp { Sum, Product, Min, Max, Average };
+
+struct Formula {
+    FormulaOp op{FormulaOp::Sum};
+    std::vector<CellRef> inputs; //ranges are expanded at parse time
+    std::string text;            //source text , kept for display and saving
+
+    //Sheet = any storage with getCellAt(x , y) const (Spreadsheet , SparseSpreadsheet)
+    template <typename Sheet>
+    double evaluate(const Sheet& sheet) const {
+        if (inputs.empty()) {
+            return 0;
+        }
+        double result{op == FormulaOp::Product ? 1.0 : 0.0};
+        if (op == FormulaOp::Min || op == FormulaOp::Max) {
+            result = sheet.getCellAt(inputs.front().x, inputs.front().y).getValue();
+        }
+        for (const auto& input : inputs) {
+            const double value{sheet.getCellAt(input.x, input.y).getValue()};
+            switch (op) {
+            case FormulaOp::Sum:
+            case FormulaOp::Average: result += value; break;
+            case FormulaOp::Product: result *= value; break;
+            case FormulaOp::Min: result = std::min(result, value); break;
+            case FormulaOp::Max: result = std::max(result, value); break;
+            }
+        }
+        return op == FormulaOp::Average ? result / static_cast<double>(inputs.size()) : result;
+    }
+};
+
+//every reference is checked against a width x height sheet BEFORE a range is expanded :
+//=SUM(A1:ZZZ99999999) throws out_of_range instead of allocating billions of inputs
+inline Formula parseFormula(std::string_view text, std::size_t width, std::size_t height) {
+    Formula formula;
+    formula.text = std::string{text};
+    const auto inSheet{[&](std::string_view name) {
+        const CellRef cell{parseCellName(name)};
+        if (cell.x >= width || cell.y >= height) {
+            throw std::out_of_range{"reference outside the sheet: " + std::string{name}};
+        }
+        return cell;
+    }};
+
+    std::string compact;
+    for (char c : text) {
+        if (!std::isspace(static_cast<unsigned char>(c))) compact += c;
+    }
+    std::string_view body{compact};
+    if (body.empty() || body.front() != '=') {
+        throw std::invalid_argument{"formula must start with '=': " + formula.text};
+    }
+    body.remove_prefix(1);
+
+    const auto open{body.find('(')};
+    if (open == std::string_view::npos) { //"=B2"
+        formula.inputs.push_back(inSheet(body));
+        return formula;
+    }
+    if (body.back() != ')') {
+        throw std::invalid_argument{"missing ')': " + formula.text};
+    }
+
+    std::string function{body.substr(0, open)};
+    std::transform(function.begin(), function.end(), function.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    if (function == "SUM") formula.op = FormulaOp::Sum;
+    else if (function == "PRODUCT") formula.op = FormulaOp::Product;
+    else if (function == "MIN") formula.op = FormulaOp::Min;
+    else if (function == "MAX") formula.op = FormulaOp::Max;
+    else if (function == "AVERAGE") formula.op = FormulaOp::Average;
+    else throw std::invalid_argument{"unknown function: " + function};
+
+    std::string_view args{body.substr(open + 1, body.size() - open - 2)};
+    while (!args.empty()) {
+        const auto comma{args.find(',')};
+        const std::string_view arg{args.substr(0, comma)};
+        const auto colon{arg.find(':')};
+        if (colon == std::string_view::npos) {
+            formula.inputs.push_back(inSheet(arg));
+        } else { //A1:C3 --> every cell of the rectangle
+            const CellRef from{inSheet(arg.substr(0, colon))};
+            const CellRef to{inSheet(arg.substr(colon + 1))};
+            for (std::size_t y = std::min(from.y, to.y); y <= std::max(from.y, to.y); ++y) {
+                for (std::size_t x = std::min(from.x, to.x); x <= std::max(from.x, to.x); ++x) {
+                    formula.inputs.push_back({ x, y });
+                }
+            }
+        }
+        args = comma == std::string_view::npos ? std::string_view{} : args.substr(comma + 1);
+    }
+    return formula;
+}
+
+class CycleError : public std::runtime_error {
+public:
+    explicit CycleError(std::vector<CellRef> cells)
+        : std::runtime_error{describe(cells)}, m_cells{std::move(cells)} {}
+
+    const std::vector<CellRef>& cells() const noexcept { return m_cells; }
+
+private:
+    static std::string describe(const std::vector<CellRef>& cells) {
+        std::string message{"circular reference:"};
+        for (const auto& cell : cells) {
+            message += ' ';
+            message += cellName(cell);
+            message += " ->";
+        }
+        if (!cells.empty()) {
+            message += ' ';
+            message += cellName(cells.front());
+        }
+        return message;
+    }
+
+    std::vector<CellRef> m_cells;
+};
+
+struct LeveledFormula {
+    CellRef cell;
+    const Formula* formula{nullptr};
+};
+
+template <typename Sheet>
+class BasicRecalcEngine {
+public:
+    explicit BasicRecalcEngine(Sheet& sheet) : m_sheet{sheet} {}
+
+    //plain value : drops the formula of that cell (if any) and recomputes its dependents
+    //returns the number of formula cells recomputed
+    std::size_t setValue(std::size_t x, std::size_t y, double value);
+    //strong guarantee : on parse error , out-of-range reference or CycleError nothing changes
+    std::size_t setFormula(std::size_t x, std::size_t y, std::string_view text);
+    void clearFormula(std::size_t x, std::size_t y);
+    const Formula* getFormula(std::size_t x, std::size_t y) const;
+    std::size_t getFormulaCount() const { return m_formulaCount; }
+    //f(CellRef , const Formula&) for every formula cell , in no particular order
+    template <typename Function>
+    void forEachFormula(Function&& f) const {
+        for (const auto& [k, node] : m_nodes) {
+            if (node.hasFormula) f(node.cell, node.formula);
+        }
+    }
+
+    //every formula cell , inputs before the cells that read them (Kahn's algorithm)
+    std::vector<CellRef> topologicalOrder() const;
+    //level 0 = formulas reading only plain values , level n = formulas whose deepest input is on level n-1
+    //cells of one level never read each other --> a level can be evaluated in parallel
+    std::vector<std::vector<LeveledFormula>> topologicalLevels() const;
+    //full recomputation in topological order
+    void recalculateAll();
+
+    Sheet& getSheet() { return m_sheet; }
+    const Sheet& getSheet() const { return m_sheet; }
+
+private:
+    using Key = std::uint64_t;
+
+    struct Node {
+        CellRef cell;
+        Formula formula;
+        bool hasFormula{false};
+        std::vector<Key> dependents; //formula cells that read this cell
+        std::uint32_t dirtyEpoch{0};  //== m_epoch --> visited in the current propagation
+    };
+
+    static Key key(std::size_t x, std::size_t y) { return (static_cast<Key>(x) << 32) | static_cast<Key>(y); }
+    static Key key(CellRef cell) { return key(cell.x, cell.y); }
+    static CellRef ref(Key k) { return { static_cast<std::size_t>(k >> 32), static_cast<std::size_t>(k & 0xffffffffu) }; }
+
+    Node& nodeAt(Key k) {
+        auto [it, inserted] = m_nodes.try_emplace(k);
+        if (inserted) it->second.cell = ref(k);
+        return it->second;
+    }
+    void link(Key cell, const Formula& formula);
+    void unlink(Key cell, const Formula& formula);
+    std::vector<CellRef> findCycle(Key cell, const Formula& formula) const;
+    std::size_t propagateFrom(Key start);
+
+    Sheet& m_sheet;
+    std::unordered_map<Key, Node> m_nodes;
+    std::size_t m_formulaCount{0};
+    std::uint32_t m_epoch{0};
+    //scratch buffers reused by every propagation (no allocation per edit in steady state)
+    std::vector<std::pair<Node*, std::size_t>> m_stack;
+    std::vector<Node*> m_postOrder;
+};
+
+template <typename Sheet>
+inline void BasicRecalcEngine<Sheet>::link(Key cell, const Formula& formula) {
+    for (const auto& input : formula.inputs) {
+        nodeAt(key(input)).dependents.push_back(cell);
+    }
+}
+
+template <typename Sheet>
+inline void BasicRecalcEngine<Sheet>::unlink(Key cell, const Formula& formula) {
+    for (const auto& input : formula.inputs) {
+        auto& dependents{nodeAt(key(input)).dependents};
+        auto it{std::find(dependents.begin(), dependents.end(), cell)};
+        if (it != dependents.end()) {
+            *it = dependents.back(); //swap-and-pop , order of dependents does not matter
+            dependents.pop_back();
+        }
+    }
+}
+
+//a new formula in `cell` closes a cycle iff one of its inputs is reachable from `cell`
+//through the dependents edges (or is `cell` itself)
+template <typename Sheet>
+inline std::vector<CellRef> BasicRecalcEngine<Sheet>::findCycle(Key cell, const Formula& formula) const {
+    std::unordered_map<Key, Key> parent{{ cell, cell }};
+    std::vector<Key> todo{cell};
+    std::unordered_map<Key, bool> isInput;
+    for (const auto& input : formula.inputs) {
+        isInput[key(input)] = true;
+    }
+    while (!todo.empty()) {
+        const Key current{todo.back()};
+        todo.pop_back();
+        if (isInput.count(current)) {
+            std::vector<CellRef> cycle;
+            for (Key k = current; k != cell; k = parent[k]) {
+                cycle.push_back(ref(k));
+            }
+            cycle.push_back(ref(cell));
+            std::reverse(cycle.begin(), cycle.end()); //cell -> ... -> input (-> cell)
+            return cycle;
+        }
+        auto it{m_nodes.find(current)};
+        if (it == m_nodes.end()) continue;
+        for (Key dependent : it->second.dependents) {
+            if (parent.emplace(dependent, current).second) {
+                todo.push_back(dependent);
+            }
+        }
+    }
+    return {};
+}
+
+template <typename Sheet>
+inline std::size_t BasicRecalcEngine<Sheet>::propagateFrom(Key start) {
+    auto it{m_nodes.find(start)};
+    if (it == m_nodes.end()) {
+        return 0;
+    }
+    ++m_epoch;
+    m_stack.clear();
+    m_postOrder.clear();
+
+    //iterative DFS over dependents (chains can be a million cells long)
+    it->second.dirtyEpoch = m_epoch;
+    m_stack.emplace_back(&it->second, 0);
+    while (!m_stack.empty()) {
+        auto& [node, next] = m_stack.back();
+        if (next < node->dependents.size()) {
+            Node& dependent{m_nodes.find(node->dependents[next++])->second};
+            if (dependent.dirtyEpoch != m_epoch) {
+                dependent.dirtyEpoch = m_epoch;
+                m_stack.emplace_back(&dependent, 0);
+            }
+        } else {
+            m_postOrder.push_back(node);
+            m_stack.pop_back();
+        }
+    }
+
+    //reverse post-order == topological order of the dirty sub-graph
+    std::size_t recomputed{0};
+    for (auto node = m_postOrder.rbegin(); node != m_postOrder.rend(); ++node) {
+        if ((*node)->hasFormula) {
+            m_sheet.setCellAt((*node)->cell.x, (*node)->cell.y, (*node)->formula.evaluate(m_sheet));
+            ++recomputed;
+        }
+    }
+    return recomputed;
+}
+
+template <typename Sheet>
+inline std::size_t BasicRecalcEngine<Sheet>::setValue(std::size_t x, std::size_t y, double value) {
+    m_sheet.setCellAt(x, y, value);
+    clearFormula(x, y);
+    return propagateFrom(key(x, y));
+}
+
+template <typename Sheet>
+inline std::size_t BasicRecalcEngine<Sheet>::setFormula(std::size_t x, std::size_t y, std::string_view text) {
+    std::as_const(m_sheet).getCellAt(x, y); //throws out_of_range before anything changes
+    Formula formula{parseFormula(text, m_sheet.getWidth(), m_sheet.getHeight())}; //every input is in the sheet
+    const Key cell{key(x, y)};
+    if (auto cycle{findCycle(cell, formula)}; !cycle.empty()) {
+        throw CycleError{std::move(cycle)};
+    }
+
+    clearFormula(x, y);
+    link(cell, formula);
+    Node& node{nodeAt(cell)};
+    node.formula = std::move(formula);
+    node.hasFormula = true;
+    ++m_formulaCount;
+    return propagateFrom(cell);
+}
+
+template <typename Sheet>
+inline void BasicRecalcEngine<Sheet>::clearFormula(std::size_t x, std::size_t y) {
+    auto it{m_nodes.find(key(x, y))};
+    if (it == m_nodes.end() || !it->second.hasFormula) {
+        return;
+    }
+    unlink(it->first, it->second.formula);
+    it->second.formula = Formula{};
+    it->second.hasFormula = false;
+    --m_formulaCount;
+}
+
+template <typename Sheet>
+inline const Formula* BasicRecalcEngine<Sheet>::getFormula(std::size_t x, std::size_t y) const {
+    auto it{m_nodes.find(key(x, y))};
+    return it != m_nodes.end() && it->second.hasFormula ? &it->second.formula : nullptr;
+}
+
+template <typename Sheet>
+inline std::vector<CellRef> BasicRecalcEngine<Sheet>::topologicalOrder() const {
+    //in-degree = number of inputs that are formula cells themselves
+    std::unordered_map<Key, std::size_t> inDegree;
+    std::vector<Key> ready;
+    for (const auto& [k, node] : m_nodes) {
+        if (!node.hasFormula) continue;
+        std::size_t degree{0};
+        for (const auto& input : node.formula.inputs) {
+            auto it{m_nodes.find(key(input))};
+            if (it->second.hasFormula) ++degree;
+        }
+        inDegree[k] = degree;
+        if (degree == 0) ready.push_back(k);
+    }
+
+    std::vector<CellRef> order;
+    order.reserve(m_formulaCount);
+    while (!ready.empty()) {
+        const Key current{ready.back()};
+        ready.pop_back();
+        order.push_back(ref(current));
+        for (Key dependent : m_nodes.find(current)->second.dependents) {
+            if (--inDegree[dependent] == 0) ready.push_back(dependent);
+        }
+    }
+    if (order.size() != m_formulaCount) { //only reachable if the graph was corrupted
+        std::vector<CellRef> cycle;
+        for (const auto& [k, degree] : inDegree) {
+            if (degree != 0) cycle.push_back(ref(k));
+        }
+        throw CycleError{std::move(cycle)};
+    }
+    return order;
+}
+
+template <typename Sheet>
+inline std::vector<std::vector<LeveledFormula>> BasicRecalcEngine<Sheet>::topologicalLevels() const {
+    std::unordered_map<Key, std::size_t> inDegree;
+    std::vector<std::vector<LeveledFormula>> levels(1);
+    for (const auto& [k, node] : m_nodes) {
+        if (!node.hasFormula) continue;
+        std::size_t degree{0};
+        for (const auto& input : node.formula.inputs) {
+            if (m_nodes.find(key(input))->second.hasFormula) ++degree;
+        }
+        inDegree[k] = degree;
+        if (degree == 0) levels.back().push_back({ node.cell, &node.formula });
+    }
+
+    std::size_t placed{0};
+    while (!levels.back().empty()) {
+        placed += levels.back().size();
+        std::vector<LeveledFormula> next;
+        for (const auto& current : levels.back()) {
+            for (Key dependent : m_nodes.find(key(current.cell))->second.dependents) {
+                if (--inDegree[dependent] == 0) {
+                    const Node& node{m_nodes.find(dependent)->second};
+                    next.push_back({ node.cell, &node.formula });
+                }
+            }
+        }
+        levels.push_back(std::move(next));
+    }
+    levels.pop_back(); //the empty level that ended the loop
+    if (placed != m_formulaCount) {
+        std::vector<CellRef> cycle;
+        for (const auto& [k, degree] : inDegree) {
+            if (degree != 0) cycle.push_back(ref(k));
+        }
+        throw CycleError{std::move(cycle)};
+    }
+    return levels;
+}
+
+template <typename Sheet>
+inline void BasicRecalcEngine<Sheet>::recalculateAll() {
+    for (const auto& cell : topologicalOrder()) {
+        m_sheet.setCellAt(cell.x, cell.y, m_nodes.find(key(cell))->second.formula.evaluate(m_sheet));
+    }
+}
+
+//the dense sheet is the common case
+using RecalcEngine = BasicRecalcEngine<Spreadsheet>;
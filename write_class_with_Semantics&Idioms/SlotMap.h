@@ -0,0 +1,194 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*
+SlotMap<T> : stable 64-bit handles to objects that are stored DENSELY
+-m_values  : the objects , contiguous (iteration = plain vector loop)
+-m_slots   : handle index --> {position in m_values , generation}
+-m_owners  : position in m_values --> slot index (needed to fix the slot of the moved element)
+-erase = swap-and-pop : the last object moves into the hole , its slot is updated
+-every erase bumps the slot generation : an old handle no longer matches --> stale , detected
+-free slots form a singly linked list threaded through Slot::position
+insert , erase , lookup : O(1)
+*/
+
+class SlotHandle {
+public:
+    SlotHandle() = default;
+
+    std::uint32_t index() const { return static_cast<std::uint32_t>(m_value); }
+    std::uint32_t generation() const { return static_cast<std::uint32_t>(m_value >> 32); }
+    std::uint64_t value() const { return m_value; }
+    static SlotHandle fromValue(std::uint64_t value) { return SlotHandle{value}; }
+
+    bool operator==(const SlotHandle&) const = default;
+
+private:
+    template <typename T> friend class SlotMap;
+    explicit SlotHandle(std::uint64_t value) : m_value{value} {}
+    SlotHandle(std::uint32_t index, std::uint32_t generation)
+        : m_value{(static_cast<std::uint64_t>(generation) << 32) | index} {}
+
+    std::uint64_t m_value{0}; //generation 0 is never handed out --> default handle is always stale
+};
+
+template <typename T>
+class SlotMap {
+public:
+    template <typename... Args>
+    SlotHandle emplace(Args&&... args);
+    SlotHandle insert(T value) { return emplace(std::move(value)); }
+
+    //false for a stale handle
+    bool erase(SlotHandle handle);
+    bool contains(SlotHandle handle) const { return find(handle) != nullptr; }
+
+    //nullptr for a stale handle
+    T* find(SlotHandle handle);
+    const T* find(SlotHandle handle) const;
+    //throws std::out_of_range for a stale handle
+    T& at(SlotHandle handle);
+    const T& at(SlotHandle handle) const;
+
+    std::size_t size() const { return m_values.size(); }
+    bool empty() const { return m_values.empty(); }
+    void reserve(std::size_t count);
+    void clear();
+
+    //dense iteration , in no particular order (erase reorders)
+    auto begin() { return m_values.begin(); }
+    auto end() { return m_values.end(); }
+    auto begin() const { return m_values.begin(); }
+    auto end() const { return m_values.end(); }
+    std::span<T> values() { return m_values; }
+    std::span<const T> values() const { return m_values; }
+    //the handle of the object at a dense position , e.g. while iterating values()
+    SlotHandle handleAt(std::size_t position) const;
+
+private:
+    struct Slot {
+        std::uint32_t position;   //occupied : index in m_values , free : next free slot (or NoFreeSlot)
+        std::uint32_t generation; //odd --> occupied
+    };
+    static constexpr std::uint32_t NoFreeSlot{std::numeric_limits<std::uint32_t>::max()};
+
+    const Slot* slotOf(SlotHandle handle) const;
+
+    std::vector<T> m_values;
+    std::vector<std::uint32_t> m_owners;
+    std::vector<Slot> m_slots;
+    std::uint32_t m_freeHead{NoFreeSlot};
+};
+
+template <typename T>
+template <typename... Args>
+SlotHandle SlotMap<T>::emplace(Args&&... args) {
+    if (m_values.size() >= NoFreeSlot) {
+        throw std::length_error{"SlotMap is full"};
+    }
+    const bool newSlot{m_freeHead == NoFreeSlot};
+    const std::uint32_t index{newSlot ? static_cast<std::uint32_t>(m_slots.size()) : m_freeHead};
+    m_values.emplace_back(std::forward<Args>(args)...);
+    const auto position{static_cast<std::uint32_t>(m_values.size() - 1)};
+    try {
+        m_owners.push_back(index);
+        if (newSlot) {
+            m_slots.push_back({ NoFreeSlot, 0 });
+        }
+    } catch (...) { //strong guarantee : undo the partial insert
+        m_owners.resize(position);
+        m_values.pop_back();
+        throw;
+    }
+
+    Slot& slot{m_slots[index]};
+    m_freeHead = slot.position;
+    slot.position = position;
+    ++slot.generation; //even (free) --> odd (occupied) , wraps after 2^31 reuses of one slot
+    return SlotHandle{index, m_slots[index].generation};
+}
+
+template <typename T>
+const typename SlotMap<T>::Slot* SlotMap<T>::slotOf(SlotHandle handle) const {
+    if (handle.index() >= m_slots.size()) {
+        return nullptr;
+    }
+    const Slot& slot{m_slots[handle.index()]};
+    return slot.generation == handle.generation() && (slot.generation & 1u) ? &slot : nullptr;
+}
+
+template <typename T>
+T* SlotMap<T>::find(SlotHandle handle) {
+    const Slot* slot{slotOf(handle)};
+    return slot ? &m_values[slot->position] : nullptr;
+}
+
+template <typename T>
+const T* SlotMap<T>::find(SlotHandle handle) const {
+    const Slot* slot{slotOf(handle)};
+    return slot ? &m_values[slot->position] : nullptr;
+}
+
+template <typename T>
+T& SlotMap<T>::at(SlotHandle handle) {
+    return const_cast<T&>(std::as_const(*this).at(handle));
+}
+
+template <typename T>
+const T& SlotMap<T>::at(SlotHandle handle) const {
+    const T* value{find(handle)};
+    if (!value) {
+        throw std::out_of_range{"stale SlotMap handle"};
+    }
+    return *value;
+}
+
+template <typename T>
+bool SlotMap<T>::erase(SlotHandle handle) {
+    if (!slotOf(handle)) {
+        return false;
+    }
+    Slot& slot{m_slots[handle.index()]};
+    const std::uint32_t position{slot.position};
+    const std::uint32_t last{static_cast<std::uint32_t>(m_values.size() - 1)};
+    if (position != last) {
+        //swap-and-pop : the last object fills the hole
+        m_values[position] = std::move(m_values[last]);
+        m_owners[position] = m_owners[last];
+        m_slots[m_owners[position]].position = position;
+    }
+    m_values.pop_back();
+    m_owners.pop_back();
+
+    ++slot.generation; //odd --> even : every handle to it is stale now
+    slot.position = m_freeHead;
+    m_freeHead = handle.index();
+    return true;
+}
+
+template <typename T>
+SlotHandle SlotMap<T>::handleAt(std::size_t position) const {
+    const std::uint32_t index{m_owners.at(position)};
+    return SlotHandle{index, m_slots[index].generation};
+}
+
+template <typename T>
+void SlotMap<T>::reserve(std::size_t count) {
+    m_values.reserve(count);
+    m_owners.reserve(count);
+    m_slots.reserve(count);
+}
+
+template <typename T>
+void SlotMap<T>::clear() {
+    //erase every object but keep the slots : old handles must stay stale
+    while (!m_values.empty()) {
+        erase(handleAt(m_values.size() - 1));
+    }
+}
@@ -0,0 +1,204 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Spreadsheet.h"
+
+/*
+-SparseSpreadsheet : same cell API as Spreadsheet , but memory scales with the POPULATED cells
+    a 10^6 x 10^4 sheet would need 80 GB as one dense block
+-hash of chunks : a chunk = ChunkWidth neighbouring cells of one row + a bitmask of populated cells
+    key = (y << 32) | (x / ChunkWidth)   --> sorting the keys gives row-major order
+-forEachNonEmpty() visits only populated cells , in row-major order
+-rule of zero : unordered_map and vector already copy , move and swap correctly
+*/
+
+class SparseSpreadsheet {
+public:
+    static constexpr std::size_t ChunkWidth{16};
+
+    SparseSpreadsheet() = default;
+    SparseSpreadsheet(std::size_t width, std::size_t height) : m_width{width}, m_height{height} {}
+
+    void setCellAt(std::size_t x, std::size_t y, const SpreadsheetCell& cell);
+    //like std::map::operator[] : the cell becomes populated
+    SpreadsheetCell& getCellAt(std::size_t x, std::size_t y);
+    //an empty cell reads as a zero cell , nothing is inserted
+    const SpreadsheetCell& getCellAt(std::size_t x, std::size_t y) const;
+    bool isPopulated(std::size_t x, std::size_t y) const;
+    void eraseCellAt(std::size_t x, std::size_t y);
+
+    std::size_t getWidth() const { return m_width; }
+    std::size_t getHeight() const { return m_height; }
+    std::size_t getPopulatedCount() const { return m_populated; }
+    //approximate heap usage : chunks + hash nodes + buckets + the order cache
+    std::size_t getMemoryUsage() const;
+
+    //f(x , y , const SpreadsheetCell&) for every populated cell , row-major order
+    template <typename Function>
+    void forEachNonEmpty(Function&& f) const;
+
+    //keeps the cells inside the new bounds
+    void resize(std::size_t newWidth, std::size_t newHeight);
+
+    void swap(SparseSpreadsheet& other) noexcept;
+
+private:
+    using Key = std::uint64_t;
+
+    struct Chunk {
+        std::array<SpreadsheetCell, ChunkWidth> cells{};
+        std::uint16_t occupied{0}; //bit i set --> cells[i] populated
+    };
+    static_assert(ChunkWidth <= 16, "Chunk::occupied has 16 bits");
+
+    static Key key(std::size_t x, std::size_t y) {
+        return (static_cast<Key>(y) << 32) | static_cast<Key>(x / ChunkWidth);
+    }
+    void verifyCoordinate(std::size_t x, std::size_t y) const;
+    const std::vector<Key>& sortedKeys() const;
+
+    std::size_t m_width{0};
+    std::size_t m_height{0};
+    std::size_t m_populated{0};
+    std::unordered_map<Key, Chunk> m_chunks;
+    //row-major order of the chunk keys , rebuilt lazily after a chunk is added or removed
+    mutable std::vector<Key> m_order;
+    mutable bool m_orderValid{true};
+};
+
+inline void swap(SparseSpreadsheet& first, SparseSpreadsheet& second) noexcept {
+    first.swap(second);
+}
+
+inline void SparseSpreadsheet::swap(SparseSpreadsheet& other) noexcept {
+    std::swap(m_width, other.m_width);
+    std::swap(m_height, other.m_height);
+    std::swap(m_populated, other.m_populated);
+    m_chunks.swap(other.m_chunks);
+    m_order.swap(other.m_order);
+    std::swap(m_orderValid, other.m_orderValid);
+}
+
+inline void SparseSpreadsheet::verifyCoordinate(std::size_t x, std::size_t y) const {
+    if (x >= m_width) {
+        throw std::out_of_range{"x coordinate out of range"};
+    }
+    if (y >= m_height) {
+        throw std::out_of_range{"y coordinate out of range"};
+    }
+}
+
+inline void SparseSpreadsheet::setCellAt(std::size_t x, std::size_t y, const SpreadsheetCell& cell) {
+    getCellAt(x, y) = cell;
+}
+
+inline SpreadsheetCell& SparseSpreadsheet::getCellAt(std::size_t x, std::size_t y) {
+    verifyCoordinate(x, y);
+    auto [it, inserted] = m_chunks.try_emplace(key(x, y));
+    if (inserted) {
+        m_orderValid = false;
+    }
+    Chunk& chunk{it->second};
+    const auto bit{static_cast<std::uint16_t>(1u << (x % ChunkWidth))};
+    if (!(chunk.occupied & bit)) {
+        chunk.occupied |= bit;
+        ++m_populated;
+    }
+    return chunk.cells[x % ChunkWidth];
+}
+
+inline const SpreadsheetCell& SparseSpreadsheet::getCellAt(std::size_t x, std::size_t y) const {
+    static const SpreadsheetCell empty{};
+    verifyCoordinate(x, y);
+    auto it{m_chunks.find(key(x, y))};
+    if (it == m_chunks.end() || !(it->second.occupied & (1u << (x % ChunkWidth)))) {
+        return empty;
+    }
+    return it->second.cells[x % ChunkWidth];
+}
+
+inline bool SparseSpreadsheet::isPopulated(std::size_t x, std::size_t y) const {
+    verifyCoordinate(x, y);
+    auto it{m_chunks.find(key(x, y))};
+    return it != m_chunks.end() && (it->second.occupied & (1u << (x % ChunkWidth)));
+}
+
+inline void SparseSpreadsheet::eraseCellAt(std::size_t x, std::size_t y) {
+    verifyCoordinate(x, y);
+    auto it{m_chunks.find(key(x, y))};
+    const auto bit{static_cast<std::uint16_t>(1u << (x % ChunkWidth))};
+    if (it == m_chunks.end() || !(it->second.occupied & bit)) {
+        return;
+    }
+    it->second.occupied &= static_cast<std::uint16_t>(~bit);
+    it->second.cells[x % ChunkWidth] = SpreadsheetCell{};
+    --m_populated;
+    if (it->second.occupied == 0) {
+        m_chunks.erase(it);
+        m_orderValid = false;
+    }
+}
+
+inline const std::vector<SparseSpreadsheet::Key>& SparseSpreadsheet::sortedKeys() const {
+    if (!m_orderValid) {
+        m_order.clear();
+        m_order.reserve(m_chunks.size());
+        for (const auto& [k, chunk] : m_chunks) {
+            m_order.push_back(k);
+        }
+        std::sort(m_order.begin(), m_order.end());
+        m_orderValid = true;
+    }
+    return m_order;
+}
+
+template <typename Function>
+void SparseSpreadsheet::forEachNonEmpty(Function&& f) const {
+    for (Key k : sortedKeys()) {
+        const Chunk& chunk{m_chunks.find(k)->second};
+        const std::size_t y{static_cast<std::size_t>(k >> 32)};
+        const std::size_t firstX{static_cast<std::size_t>(k & 0xffffffffu) * ChunkWidth};
+        //walk only the set bits of the mask
+        for (unsigned mask = chunk.occupied; mask != 0; mask &= mask - 1) {
+            const auto i{static_cast<std::size_t>(std::countr_zero(mask))};
+            f(firstX + i, y, chunk.cells[i]);
+        }
+    }
+}
+
+inline void SparseSpreadsheet::resize(std::size_t newWidth, std::size_t newHeight) {
+    for (auto it = m_chunks.begin(); it != m_chunks.end();) {
+        const std::size_t y{static_cast<std::size_t>(it->first >> 32)};
+        const std::size_t firstX{static_cast<std::size_t>(it->first & 0xffffffffu) * ChunkWidth};
+        Chunk& chunk{it->second};
+        for (std::size_t i = 0; i < ChunkWidth; ++i) {
+            if ((chunk.occupied & (1u << i)) && (y >= newHeight || firstX + i >= newWidth)) {
+                chunk.occupied &= static_cast<std::uint16_t>(~(1u << i));
+                chunk.cells[i] = SpreadsheetCell{};
+                --m_populated;
+            }
+        }
+        if (chunk.occupied == 0) {
+            it = m_chunks.erase(it);
+            m_orderValid = false;
+        } else {
+            ++it;
+        }
+    }
+    m_width = newWidth;
+    m_height = newHeight;
+}
+
+inline std::size_t SparseSpreadsheet::getMemoryUsage() const {
+    //node = next pointer + cached hash + key + chunk
+    constexpr std::size_t nodeSize{2 * sizeof(void*) + sizeof(Key) + sizeof(Chunk)};
+    return m_chunks.size() * nodeSize + m_chunks.bucket_count() * sizeof(void*) +
+           m_order.capacity() * sizeof(Key);
+}
@@ -0,0 +1,282 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+/*
+-SpreadsheetCell : one numeric value, trivially copyable so a block of cells
+    can be copied with memcpy and summed with SIMD instructions
+-Spreadsheet : m_width * m_height cells in ONE contiguous row-major block
+    cell (x , y) lives at m_cells[y * m_width + x]
+    -row y      --> m_cells[y * m_width] ... m_cells[y * m_width + m_width - 1] (contiguous)
+    -column x   --> every m_width-th cell (strided)
+-copy-and-swap for copy assignment , moveFrom()/swap() for move (all noexcept)
+-read-only view : m_cells may point into memory owned by someone else (a mapped file)
+    m_backing keeps that memory alive , the first non-const access copies the cells
+    into an owned block (copy-on-write) and commits it with swap()
+*/
+
+class SpreadsheetCell {
+public:
+    SpreadsheetCell() = default;
+    SpreadsheetCell(double initialValue) : m_value{initialValue} {}
+
+    void setValue(double value) { m_value = value; }
+    double getValue() const { return m_value; }
+
+private:
+    double m_value{0};
+};
+
+class Spreadsheet {
+public:
+    Spreadsheet() = default;
+    Spreadsheet(std::size_t width, std::size_t height);
+    Spreadsheet(const Spreadsheet& src);
+    Spreadsheet(Spreadsheet&& src) noexcept;
+    ~Spreadsheet();
+
+    Spreadsheet& operator=(const Spreadsheet& rhs);
+    Spreadsheet& operator=(Spreadsheet&& rhs) noexcept;
+
+    //wraps width * height cells that stay owned by `backing` , nothing is copied
+    static Spreadsheet readOnlyView(std::size_t width, std::size_t height,
+                                    const SpreadsheetCell* cells, std::shared_ptr<const void> backing);
+    bool isView() const { return m_backing != nullptr; }
+
+    void setCellAt(std::size_t x, std::size_t y, const SpreadsheetCell& cell);
+    SpreadsheetCell& getCellAt(std::size_t x, std::size_t y);
+    const SpreadsheetCell& getCellAt(std::size_t x, std::size_t y) const;
+
+    std::size_t getWidth() const { return m_width; }
+    std::size_t getHeight() const { return m_height; }
+    std::size_t getCapacity() const { return m_capacity; }
+
+    //contiguous views : no bounds check per cell , the compiler can vectorize loops over them
+    std::span<SpreadsheetCell> row(std::size_t y);
+    std::span<const SpreadsheetCell> row(std::size_t y) const;
+    std::span<SpreadsheetCell> cells() { makeOwned(); return { m_cells, m_width * m_height }; }
+    std::span<const SpreadsheetCell> cells() const { return { m_cells, m_width * m_height }; }
+
+    double sumRow(std::size_t y) const;
+    double sumColumn(std::size_t x) const;
+    //all column sums in one row-major pass (each row is added to the accumulator as a vector)
+    void sumColumns(std::span<double> out) const;
+
+    //keeps the overlapping cells , new cells are zero
+    //-same width and enough capacity  --> no allocation at all
+    //-otherwise                        --> ONE new block , each kept row copied once
+    void resize(std::size_t newWidth, std::size_t newHeight);
+    void reserve(std::size_t cellCount);
+
+    void swap(Spreadsheet& other) noexcept;
+
+private:
+    void verifyCoordinate(std::size_t x, std::size_t y) const;
+    //copy-on-write : called by every non-const access
+    void makeOwned();
+    void cleanup() noexcept;
+    void moveFrom(Spreadsheet& src) noexcept;
+
+    std::size_t m_width{0};
+    std::size_t m_height{0};
+    std::size_t m_capacity{0};
+    SpreadsheetCell* m_cells{nullptr};
+    std::shared_ptr<const void> m_backing; //non-null --> m_cells is borrowed , never written
+};
+
+inline void swap(Spreadsheet& first, Spreadsheet& second) noexcept {
+    first.swap(second);
+}
+
+inline Spreadsheet::Spreadsheet(std::size_t width, std::size_t height)
+    : m_width{width}, m_height{height}, m_capacity{width * height},
+      m_cells{new SpreadsheetCell[width * height]{}} {
+}
+
+inline Spreadsheet::Spreadsheet(const Spreadsheet& src)
+    : Spreadsheet{src.m_width, src.m_height} {
+    std::copy_n(src.m_cells, m_width * m_height, m_cells);
+}
+
+inline Spreadsheet::Spreadsheet(Spreadsheet&& src) noexcept {
+    moveFrom(src);
+}
+
+inline Spreadsheet::~Spreadsheet() {
+    cleanup();
+}
+
+inline Spreadsheet& Spreadsheet::operator=(const Spreadsheet& rhs) {
+    Spreadsheet temp{rhs}; // Create temporary copy of rhs (may throw , *this untouched)
+    swap(temp);            // Commit with non-throwing operations only
+    return *this;
+}
+
+inline Spreadsheet& Spreadsheet::operator=(Spreadsheet&& rhs) noexcept {
+    if (this == &rhs) {
+        return *this;
+    }
+    cleanup();
+    moveFrom(rhs);
+    return *this;
+}
+
+inline void Spreadsheet::swap(Spreadsheet& other) noexcept {
+    std::swap(m_width, other.m_width);
+    std::swap(m_height, other.m_height);
+    std::swap(m_capacity, other.m_capacity);
+    std::swap(m_cells, other.m_cells);
+    m_backing.swap(other.m_backing);
+}
+
+inline void Spreadsheet::cleanup() noexcept {
+    if (m_backing) {
+        m_backing.reset(); //the view does not own m_cells
+    } else {
+        delete[] m_cells;
+    }
+    m_cells = nullptr;
+    m_width = m_height = m_capacity = 0;
+}
+
+inline void Spreadsheet::moveFrom(Spreadsheet& src) noexcept {
+    // Shallow copy of data
+    m_width = src.m_width;
+    m_height = src.m_height;
+    m_capacity = src.m_capacity;
+    m_cells = src.m_cells;
+    m_backing = std::move(src.m_backing);
+
+    // Reset the source object, because ownership has been moved!
+    src.m_width = 0;
+    src.m_height = 0;
+    src.m_capacity = 0;
+    src.m_cells = nullptr;
+}
+
+inline Spreadsheet Spreadsheet::readOnlyView(std::size_t width, std::size_t height,
+                                             const SpreadsheetCell* cells, std::shared_ptr<const void> backing) {
+    if (!backing) {
+        throw std::invalid_argument{"a read-only view needs the owner of its cells"};
+    }
+    Spreadsheet view;
+    view.m_width = width;
+    view.m_height = height;
+    view.m_capacity = width * height;
+    view.m_cells = const_cast<SpreadsheetCell*>(cells); //only read while m_backing is set
+    view.m_backing = std::move(backing);
+    return view;
+}
+
+inline void Spreadsheet::makeOwned() {
+    if (m_backing) {
+        Spreadsheet owned{*this}; //copy constructor : new block , may throw , *this untouched
+        swap(owned);              //owned now holds the view and releases it
+    }
+}
+
+inline void Spreadsheet::verifyCoordinate(std::size_t x, std::size_t y) const {
+    if (x >= m_width) {
+        throw std::out_of_range{"x coordinate out of range"};
+    }
+    if (y >= m_height) {
+        throw std::out_of_range{"y coordinate out of range"};
+    }
+}
+
+inline void Spreadsheet::setCellAt(std::size_t x, std::size_t y, const SpreadsheetCell& cell) {
+    verifyCoordinate(x, y);
+    makeOwned();
+    m_cells[y * m_width + x] = cell;
+}
+
+inline SpreadsheetCell& Spreadsheet::getCellAt(std::size_t x, std::size_t y) {
+    verifyCoordinate(x, y); //before makeOwned : a bad coordinate must not copy a shared sheet first
+    makeOwned();
+    return const_cast<SpreadsheetCell&>(std::as_const(*this).getCellAt(x, y));
+}
+
+inline const SpreadsheetCell& Spreadsheet::getCellAt(std::size_t x, std::size_t y) const {
+    verifyCoordinate(x, y);
+    return m_cells[y * m_width + x];
+}
+
+inline std::span<SpreadsheetCell> Spreadsheet::row(std::size_t y) {
+    verifyCoordinate(0, y);
+    makeOwned();
+    return { m_cells + y * m_width, m_width };
+}
+
+inline std::span<const SpreadsheetCell> Spreadsheet::row(std::size_t y) const {
+    verifyCoordinate(0, y);
+    return { m_cells + y * m_width, m_width };
+}
+
+inline double Spreadsheet::sumRow(std::size_t y) const {
+    double sum{0};
+    for (const auto& cell : row(y)) {
+        sum += cell.getValue();
+    }
+    return sum;
+}
+
+inline double Spreadsheet::sumColumn(std::size_t x) const {
+    verifyCoordinate(x, 0);
+    double sum{0};
+    const SpreadsheetCell* cell{m_cells + x};
+    for (std::size_t y = 0; y < m_height; ++y, cell += m_width) {
+        sum += cell->getValue();
+    }
+    return sum;
+}
+
+inline void Spreadsheet::sumColumns(std::span<double> out) const {
+    if (out.size() < m_width) {
+        throw std::invalid_argument{"output span smaller than sheet width"};
+    }
+    std::fill_n(out.begin(), m_width, 0.0);
+    double* __restrict acc{out.data()};
+    for (std::size_t y = 0; y < m_height; ++y) {
+        const SpreadsheetCell* __restrict r{m_cells + y * m_width};
+        for (std::size_t x = 0; x < m_width; ++x) {
+            acc[x] += r[x].getValue();
+        }
+    }
+}
+
+inline void Spreadsheet::reserve(std::size_t cellCount) {
+    makeOwned();
+    if (cellCount <= m_capacity) {
+        return;
+    }
+    auto* cells{new SpreadsheetCell[cellCount]{}};
+    std::copy_n(m_cells, m_width * m_height, cells);
+    delete[] m_cells;
+    m_cells = cells;
+    m_capacity = cellCount;
+}
+
+inline void Spreadsheet::resize(std::size_t newWidth, std::size_t newHeight) {
+    makeOwned();
+    const std::size_t newCount{newWidth * newHeight};
+    if (newWidth == m_width && newCount <= m_capacity) {
+        // Rows keep their offsets : only zero the rows that become visible again
+        if (newHeight > m_height) {
+            std::fill(m_cells + m_width * m_height, m_cells + newCount, SpreadsheetCell{});
+        }
+        m_height = newHeight;
+        return;
+    }
+
+    Spreadsheet resized{newWidth, newHeight};
+    const std::size_t keepWidth{std::min(m_width, newWidth)};
+    const std::size_t keepHeight{std::min(m_height, newHeight)};
+    for (std::size_t y = 0; y < keepHeight; ++y) {
+        std::copy_n(m_cells + y * m_width, keepWidth, resized.m_cells + y * newWidth);
+    }
+    swap(resized);
+}
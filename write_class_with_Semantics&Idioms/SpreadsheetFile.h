@@ -0,0 +1,352 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "RecalcEngine.h"
+
+/*
+Binary snapshot of a Spreadsheet (+ the formulas of its RecalcEngine) , version 1 , little-endian
+the values , formulas and strings sections start on a 64-byte boundary , so they can be used IN PLACE from an mmap :
+
+    | header (72 bytes)                                  |
+    | types    : uint8_t[width * height]   (CellType)    |
+    | values   : double[width * height]    row-major     |  <-- same layout as Spreadsheet::m_cells
+    | formulas : FormulaEntry[formulaCount] sorted by cell index
+    | strings  : char[stringsSize]  formula texts , not null-terminated
+
+-saveSpreadsheet() writes a temporary file next to the target and renames it over the target :
+    saving the view of a mapped file back to its own path is safe (the mapping keeps the old inode) ,
+    and a failed save leaves the old file untouched
+    the temporary file is fsync'ed before the rename and the directory after it : once saveSpreadsheet()
+    returns , a crash leaves the new file , never an empty or half-written one under the target's name
+-SpreadsheetFile::open() = open + mmap + header checks : no cell is read , no parsing
+-SpreadsheetFile::sheet() = Spreadsheet::readOnlyView() over the values section
+    the first edit copies the cells into owned storage (copy-on-write , see Spreadsheet::makeOwned)
+*/
+
+enum class CellType : std::uint8_t { Empty = 0, Number = 1, Formula = 2 };
+
+struct SpreadsheetFileHeader {
+    char magic[8];              //"SSHEET\0\0"
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint64_t width;
+    std::uint64_t height;
+    std::uint64_t valuesOffset; //types start right after the header
+    std::uint64_t formulaCount;
+    std::uint64_t formulasOffset;
+    std::uint64_t stringsOffset;
+    std::uint64_t stringsSize;
+};
+
+struct FormulaEntry {
+    std::uint64_t cellIndex; //y * width + x
+    std::uint64_t textOffset; //into the string heap
+    std::uint64_t textLength;
+};
+
+static_assert(sizeof(SpreadsheetFileHeader) == 72, "the header layout is part of the file format");
+static_assert(sizeof(SpreadsheetCell) == sizeof(double) && std::is_trivially_copyable_v<SpreadsheetCell>,
+              "the values section is used as SpreadsheetCell[] in place");
+
+inline constexpr char SpreadsheetFileMagic[8]{ 'S', 'S', 'H', 'E', 'E', 'T', 0, 0 };
+inline constexpr std::uint32_t SpreadsheetFileVersion{1};
+
+namespace spreadsheet_file_detail {
+    inline std::uint64_t alignUp(std::uint64_t offset) { return (offset + 63) & ~std::uint64_t{63}; }
+
+    inline void pad(std::ofstream& out, std::uint64_t& offset) {
+        static const char zeros[64]{};
+        const std::uint64_t aligned{alignUp(offset)};
+        out.write(zeros, static_cast<std::streamsize>(aligned - offset));
+        offset = aligned;
+    }
+
+    inline std::string directoryOf(const std::string& path) {
+        const std::size_t slash{path.find_last_of('/')};
+        if (slash == std::string::npos) return ".";
+        return slash == 0 ? "/" : path.substr(0, slash);
+    }
+
+    //a unique file in the directory of `path` : same file system , so rename() over `path` is atomic
+    //removed again unless commit() renamed it
+    //the descriptor stays open until commit() : the data written through another stream is fsync'ed through it
+    struct TemporaryFile {
+        explicit TemporaryFile(const std::string& path) : name{path + ".XXXXXX"} {
+            fd = mkstemp(name.data());
+            if (fd < 0) {
+                throw std::system_error{errno, std::generic_category(), "cannot create a temporary file for " + path};
+            }
+            //mkstemp creates 0600 : keep the mode of the file we replace , or the usual one for a new file
+            struct stat target {};
+            mode_t mode;
+            if (stat(path.c_str(), &target) == 0) {
+                mode = target.st_mode & 07777;
+            } else {
+                const mode_t mask{umask(0)};
+                umask(mask);
+                mode = 0666 & ~mask;
+            }
+            if (fchmod(fd, mode) != 0) {
+                const int error{errno};
+                ::close(fd);
+                ::unlink(name.c_str());
+                throw std::system_error{error, std::generic_category(), "cannot set the mode of " + name};
+            }
+        }
+
+        TemporaryFile(const TemporaryFile&) = delete;
+        TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+        ~TemporaryFile() {
+            if (fd >= 0) ::close(fd);
+            if (!committed) ::unlink(name.c_str());
+        }
+
+        //call once every stream writing `name` is closed
+        void commit(const std::string& path) {
+            //data first : a rename that reaches the disk before the data would replace the old file with a hole
+            if (::fsync(fd) != 0) {
+                throw std::system_error{errno, std::generic_category(), "cannot flush " + name};
+            }
+            ::close(fd);
+            fd = -1;
+            if (std::rename(name.c_str(), path.c_str()) != 0) {
+                throw std::system_error{errno, std::generic_category(), "cannot replace " + path};
+            }
+            committed = true;
+            //then the directory entry : without it the rename itself may be lost in a crash
+            const int directory{::open(directoryOf(path).c_str(), O_RDONLY | O_DIRECTORY)};
+            const bool synced{directory >= 0 && ::fsync(directory) == 0};
+            const int error{errno};
+            if (directory >= 0) ::close(directory);
+            if (!synced) {
+                throw std::system_error{error, std::generic_category(),
+                                        "replaced " + path + " but cannot flush its directory"};
+            }
+        }
+
+        std::string name;
+        int fd{-1};
+        bool committed{false};
+    };
+
+    //owns one read-only mapping
+    struct Mapping {
+        const std::byte* data{nullptr};
+        std::size_t size{0};
+        ~Mapping() {
+            if (data) munmap(const_cast<std::byte*>(data), size);
+        }
+    };
+}
+
+//formulas are optional : pass the engine that owns them to store their text
+template <typename Engine = RecalcEngine>
+void saveSpreadsheet(const std::string& path, const Spreadsheet& sheet, const Engine* engine = nullptr) {
+    using namespace spreadsheet_file_detail;
+    const std::size_t cellCount{sheet.getWidth() * sheet.getHeight()};
+
+    std::vector<CellType> types(cellCount, CellType::Number);
+    std::vector<FormulaEntry> formulas;
+    std::string strings;
+    if (engine) {
+        engine->forEachFormula([&](CellRef cell, const Formula& formula) {
+            const std::uint64_t index{cell.y * sheet.getWidth() + cell.x};
+            types[index] = CellType::Formula;
+            formulas.push_back({ index, strings.size(), formula.text.size() });
+            strings += formula.text;
+        });
+        std::sort(formulas.begin(), formulas.end(),
+                  [](const FormulaEntry& lhs, const FormulaEntry& rhs) { return lhs.cellIndex < rhs.cellIndex; });
+    }
+
+    SpreadsheetFileHeader header{};
+    std::memcpy(header.magic, SpreadsheetFileMagic, sizeof(header.magic));
+    header.version = SpreadsheetFileVersion;
+    header.headerSize = sizeof(SpreadsheetFileHeader);
+    header.width = sheet.getWidth();
+    header.height = sheet.getHeight();
+    header.valuesOffset = alignUp(sizeof(header) + cellCount);
+    header.formulaCount = formulas.size();
+    header.formulasOffset = alignUp(header.valuesOffset + cellCount * sizeof(double));
+    header.stringsOffset = alignUp(header.formulasOffset + formulas.size() * sizeof(FormulaEntry));
+    header.stringsSize = strings.size();
+
+    //never truncate `path` in place : it may be the file that backs `sheet` (a view from SpreadsheetFile)
+    TemporaryFile temporary{path};
+    std::ofstream out{temporary.name, std::ios::binary | std::ios::trunc};
+    if (!out) {
+        throw std::system_error{errno, std::generic_category(), "cannot create " + temporary.name};
+    }
+    std::uint64_t offset{sizeof(header)};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(types.data()), static_cast<std::streamsize>(cellCount));
+    offset += cellCount;
+    pad(out, offset);
+    out.write(reinterpret_cast<const char*>(sheet.cells().data()), static_cast<std::streamsize>(sheet.cells().size_bytes()));
+    offset += sheet.cells().size_bytes();
+    pad(out, offset);
+    out.write(reinterpret_cast<const char*>(formulas.data()),
+              static_cast<std::streamsize>(formulas.size() * sizeof(FormulaEntry)));
+    offset += formulas.size() * sizeof(FormulaEntry);
+    pad(out, offset);
+    out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+    out.close();
+    if (!out) {
+        throw std::system_error{errno, std::generic_category(), "cannot write " + temporary.name};
+    }
+    temporary.commit(path);
+}
+
+class SpreadsheetFile {
+public:
+    static SpreadsheetFile open(const std::string& path);
+
+    std::size_t getWidth() const { return m_header->width; }
+    std::size_t getHeight() const { return m_header->height; }
+    std::size_t getFormulaCount() const { return m_header->formulaCount; }
+
+    CellType getCellType(std::size_t x, std::size_t y) const;
+    //empty view for a non-formula cell
+    std::string_view getFormulaText(std::size_t x, std::size_t y) const;
+
+    //zero-copy sheet over the mapping , it keeps the mapping alive on its own
+    Spreadsheet sheet() const;
+    //re-creates the formulas in `engine` (they are parsed here , only when editing is wanted)
+    template <typename Engine>
+    void loadFormulas(Engine& engine) const;
+
+private:
+    explicit SpreadsheetFile(std::shared_ptr<const spreadsheet_file_detail::Mapping> mapping);
+    const std::byte* section(std::uint64_t offset) const { return m_mapping->data + offset; }
+    void verifyCoordinate(std::size_t x, std::size_t y) const;
+
+    std::shared_ptr<const spreadsheet_file_detail::Mapping> m_mapping;
+    const SpreadsheetFileHeader* m_header{nullptr};
+    const CellType* m_types{nullptr};
+    const SpreadsheetCell* m_values{nullptr};
+    const FormulaEntry* m_formulas{nullptr};
+    const char* m_strings{nullptr};
+};
+
+inline SpreadsheetFile SpreadsheetFile::open(const std::string& path) {
+    const int fd{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (fd < 0) {
+        throw std::system_error{errno, std::generic_category(), "cannot open " + path};
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        const int error{errno};
+        ::close(fd);
+        throw std::system_error{error, std::generic_category(), "cannot stat " + path};
+    }
+    if (static_cast<std::size_t>(info.st_size) < sizeof(SpreadsheetFileHeader)) {
+        ::close(fd);
+        throw std::runtime_error{path + ": too small for a spreadsheet file"};
+    }
+    void* data{mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0)};
+    const int error{errno};
+    ::close(fd); //the mapping stays valid after close
+    if (data == MAP_FAILED) {
+        throw std::system_error{error, std::generic_category(), "cannot map " + path};
+    }
+    auto mapping{std::make_shared<spreadsheet_file_detail::Mapping>()};
+    mapping->data = static_cast<const std::byte*>(data);
+    mapping->size = static_cast<std::size_t>(info.st_size);
+    return SpreadsheetFile{std::move(mapping)};
+}
+
+inline SpreadsheetFile::SpreadsheetFile(std::shared_ptr<const spreadsheet_file_detail::Mapping> mapping)
+    : m_mapping{std::move(mapping)} {
+    m_header = reinterpret_cast<const SpreadsheetFileHeader*>(section(0));
+    if (std::memcmp(m_header->magic, SpreadsheetFileMagic, sizeof(m_header->magic)) != 0) {
+        throw std::runtime_error{"not a spreadsheet file"};
+    }
+    if (m_header->version != SpreadsheetFileVersion || m_header->headerSize != sizeof(SpreadsheetFileHeader)) {
+        throw std::runtime_error{"unsupported spreadsheet file version " + std::to_string(m_header->version)};
+    }
+    //bounds of every section are checked once here , never again per cell
+    //every section : offset <= size && length <= size - offset , counts are divided , never multiplied ,
+    //so a crafted header cannot wrap a uint64 into a small , "valid" number
+    const SpreadsheetFileHeader& h{*m_header};
+    const std::uint64_t size{m_mapping->size};
+    const auto within{[size](std::uint64_t offset, std::uint64_t length) {
+        return offset <= size && length <= size - offset;
+    }};
+    const bool dimensionsFit{h.width == 0 || h.height <= size / h.width};
+    const std::uint64_t cellCount{dimensionsFit ? h.width * h.height : 0}; //<= size once dimensionsFit
+    const bool fits{dimensionsFit &&
+                    within(sizeof(SpreadsheetFileHeader), cellCount) &&
+                    h.valuesOffset >= sizeof(SpreadsheetFileHeader) + cellCount &&
+                    h.valuesOffset % alignof(double) == 0 &&
+                    cellCount <= size / sizeof(double) && within(h.valuesOffset, cellCount * sizeof(double)) &&
+                    h.formulasOffset >= h.valuesOffset + cellCount * sizeof(double) &&
+                    h.formulasOffset % alignof(FormulaEntry) == 0 &&
+                    h.formulaCount <= size / sizeof(FormulaEntry) &&
+                    within(h.formulasOffset, h.formulaCount * sizeof(FormulaEntry)) &&
+                    h.stringsOffset >= h.formulasOffset + h.formulaCount * sizeof(FormulaEntry) &&
+                    within(h.stringsOffset, h.stringsSize)};
+    if (!fits) {
+        throw std::runtime_error{"truncated or corrupt spreadsheet file"};
+    }
+    m_types = reinterpret_cast<const CellType*>(section(sizeof(SpreadsheetFileHeader)));
+    m_values = reinterpret_cast<const SpreadsheetCell*>(section(m_header->valuesOffset));
+    m_formulas = reinterpret_cast<const FormulaEntry*>(section(m_header->formulasOffset));
+    m_strings = reinterpret_cast<const char*>(section(m_header->stringsOffset));
+}
+
+inline void SpreadsheetFile::verifyCoordinate(std::size_t x, std::size_t y) const {
+    if (x >= getWidth()) {
+        throw std::out_of_range{"x coordinate out of range"};
+    }
+    if (y >= getHeight()) {
+        throw std::out_of_range{"y coordinate out of range"};
+    }
+}
+
+inline CellType SpreadsheetFile::getCellType(std::size_t x, std::size_t y) const {
+    verifyCoordinate(x, y);
+    return m_types[y * getWidth() + x];
+}
+
+inline std::string_view SpreadsheetFile::getFormulaText(std::size_t x, std::size_t y) const {
+    verifyCoordinate(x, y);
+    const std::uint64_t index{y * getWidth() + x};
+    const FormulaEntry* end{m_formulas + getFormulaCount()};
+    const FormulaEntry* entry{std::lower_bound(m_formulas, end, index,
+        [](const FormulaEntry& e, std::uint64_t value) { return e.cellIndex < value; })};
+    if (entry == end || entry->cellIndex != index || entry->textOffset > m_header->stringsSize ||
+        entry->textLength > m_header->stringsSize - entry->textOffset) {
+        return {};
+    }
+    return { m_strings + entry->textOffset, static_cast<std::size_t>(entry->textLength) };
+}
+
+inline Spreadsheet SpreadsheetFile::sheet() const {
+    return Spreadsheet::readOnlyView(getWidth(), getHeight(), m_values, m_mapping);
+}
+
+template <typename Engine>
+void SpreadsheetFile::loadFormulas(Engine& engine) const {
+    for (std::size_t i = 0; i < getFormulaCount(); ++i) {
+        const std::size_t index{static_cast<std::size_t>(m_formulas[i].cellIndex)};
+        engine.setFormula(index % getWidth(), index / getWidth(), getFormulaText(index % getWidth(), index / getWidth()));
+    }
+}
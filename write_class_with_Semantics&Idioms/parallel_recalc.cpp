@@ -0,0 +1,61 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include "ParallelRecalc.h"
+
+using namespace std;
+//g++ -std=c++20 -O3 -march=native -pthread parallel_recalc.cpp -o parallel_recalc
+
+//columns A..E hold values , every other cell (x , y) = SUM(three cells of the previous column around y)
+//--> one topological level per column , `height` independent cells per level
+void buildSheet(RecalcEngine& engine, size_t width, size_t height) {
+    for (size_t y = 0; y < height; ++y) {
+        for (size_t x = 0; x < 5; ++x) {
+            engine.setValue(x, y, static_cast<double>((x + 1) * (y % 7 + 1)) / 8);
+        }
+    }
+    for (size_t x = 5; x < width; ++x) {
+        for (size_t y = 0; y < height; ++y) {
+            const size_t up = y == 0 ? 0 : y - 1;
+            const size_t down = y + 1 == height ? y : y + 1;
+            engine.setFormula(x, y, "=AVERAGE(" + cellName({ x - 1, up }) + ":" + cellName({ x - 1, down }) +
+                                    "," + cellName({ x % 5, y }) + ")");
+        }
+    }
+}
+
+bool sameCells(const Spreadsheet& lhs, const Spreadsheet& rhs) {
+    //bitwise comparison : parallel must give exactly the serial doubles
+    return lhs.cells().size() == rhs.cells().size() &&
+           memcmp(lhs.cells().data(), rhs.cells().data(), lhs.cells().size_bytes()) == 0;
+}
+
+int main() {
+    constexpr size_t width = 200;
+    constexpr size_t height = 5000; //1M cells , 195 levels of 5000 formulas
+    Spreadsheet sheet(width, height);
+    RecalcEngine engine(sheet);
+    buildSheet(engine, width, height);
+    cout << engine.getFormulaCount() << " formulas in " << engine.topologicalLevels().size() << " levels" << endl;
+
+    auto start = chrono::steady_clock::now();
+    engine.recalculateAll();
+    const double serial = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    const Spreadsheet expected = sheet;
+    cout << "serial          : " << serial << " ms" << endl;
+    cout << "hardware threads: " << thread::hardware_concurrency() << endl;
+
+    for (unsigned threads : { 1u, 2u, 4u, 8u, 16u, 32u, 64u }) {
+        for (size_t x = 5; x < width; ++x) { //forget the previous results
+            for (size_t y = 0; y < height; ++y) sheet.setCellAt(x, y, 0);
+        }
+        ParallelRecalculator parallel(engine, threads);
+        start = chrono::steady_clock::now();
+        parallel.recalculateAll();
+        const double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << threads << " threads\t: " << elapsed << " ms\tspeedup " << serial / elapsed
+             << (sameCells(sheet, expected) ? "\tidentical" : "\tMISMATCH") << endl;
+    }
+    return 0;
+}
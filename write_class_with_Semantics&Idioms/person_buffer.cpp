@@ -0,0 +1,104 @@
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include "PersonBuffer.h"
+
+using namespace std;
+//g++ -std=c++20 -O3 -march=native person_buffer.cpp -o person_buffer
+
+bool samePerson(const Person& person, const PersonView& view) {
+    if (person.getId() != view.id() || person.getName() != view.name() ||
+        person.getFriends().size() != view.friendCount()) {
+        return false;
+    }
+    for (size_t i = 0; i < view.friendCount(); ++i) {
+        if (person.getFriends()[i].getName() != view.friendName(i)) return false;
+    }
+    return true;
+}
+
+vector<Person> createPeople(int count) {
+    const char* names[] = { "Ahmed", "Nader", "Sayed", "jhon", "Mona", "Omar" };
+    vector<Person> people;
+    people.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Person person(i, string(names[i % 6]) + "_" + to_string(i));
+        for (int f = 0; f < i % 4; ++f) person.addFriendByVlaueMove(MyString(names[(i + f) % 6]));
+        people.push_back(std::move(person));
+    }
+    return people;
+}
+
+void roundTripChecks() {
+    vector<Person> people = createPeople(1000);
+    people.emplace_back(-7, ""); //negative id , empty name , no friends
+
+    vector<byte> buffer;
+    for (bool deduplicate : { false, true }) {
+        PersonBufferBuilder builder(deduplicate);
+        for (const Person& person : people) builder.add(person);
+        buffer = builder.finish();
+
+        PersonBufferView view(buffer);
+        bool ok = view.size() == people.size();
+        for (size_t i = 0; ok && i < people.size(); ++i) {
+            ok = samePerson(people[i], view[i]) && samePerson(view[i].toPerson(), view[i]);
+        }
+        cout << "round trip of " << people.size() << " persons (deduplicate = " << deduplicate << ") : "
+             << (ok ? "OK" : "FAILED") << endl;
+    }
+    PersonBufferView view(buffer);
+
+    vector<byte> truncated(buffer.begin(), buffer.begin() + buffer.size() / 2);
+    try {
+        PersonBufferView broken(truncated);
+    } catch (const invalid_argument& e) {
+        cout << "truncated buffer rejected : " << e.what() << endl;
+    }
+    view[1].toPerson().printData();
+}
+
+void benchmark() {
+    constexpr int count = 1'000'000;
+    const vector<Person> people = createPeople(count);
+
+    auto start = chrono::steady_clock::now();
+    ostringstream text;
+    for (const Person& person : people) person.printData(text);
+    const string output = text.str();
+    const double textTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    PersonBufferBuilder builder;
+    builder.reserve(count, output.size());
+    for (const Person& person : people) builder.add(person);
+    const vector<byte> buffer = builder.finish();
+    const double buildTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    PersonBufferBuilder dedupBuilder(true);
+    dedupBuilder.reserve(count, output.size());
+    for (const Person& person : people) dedupBuilder.add(person);
+    const size_t dedupSize = dedupBuilder.finish().size();
+    const double dedupTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    PersonBufferView view(buffer);
+    size_t checksum = 0;
+    for (size_t i = 0; i < view.size(); ++i) {
+        const PersonView person = view[i];
+        checksum += static_cast<size_t>(person.id()) + person.name().size() + person.friendCount();
+    }
+    const double readTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "printData() text : " << textTime << " ms , " << output.size() / 1e6 << " MB" << endl;
+    cout << "binary build     : " << buildTime << " ms , " << buffer.size() / 1e6 << " MB" << endl;
+    cout << "binary build (deduplicated strings) : " << dedupTime << " ms , " << dedupSize / 1e6 << " MB" << endl;
+    cout << "binary read      : " << readTime << " ms (open + visit every field , checksum " << checksum << ")" << endl;
+}
+
+int main() {
+    roundTripChecks();
+    benchmark();
+    return 0;
+}
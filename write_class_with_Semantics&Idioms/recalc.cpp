@@ -0,0 +1,95 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "RecalcEngine.h"
+
+using namespace std;
+//g++ -std=c++20 -O3 -march=native recalc.cpp -o recalc
+
+void smallExample() {
+    Spreadsheet sheet(4, 4);
+    RecalcEngine engine(sheet);
+
+    engine.setValue(0, 0, 10); //A1
+    engine.setValue(0, 1, 20); //A2
+    engine.setValue(0, 2, 30); //A3
+    engine.setFormula(1, 0, "=SUM(A1:A3)");       //B1
+    engine.setFormula(2, 0, "=PRODUCT(B1, A1)");  //C1
+    engine.setFormula(3, 0, "=AVERAGE(A1:A3)");   //D1
+    cout << "B1 = " << sheet.getCellAt(1, 0).getValue()
+         << " , C1 = " << sheet.getCellAt(2, 0).getValue()
+         << " , D1 = " << sheet.getCellAt(3, 0).getValue() << endl;
+
+    size_t recomputed = engine.setValue(0, 1, 50); //A2 --> B1 , C1 , D1
+    cout << "edit A2 recomputed " << recomputed << " cells : B1 = " << sheet.getCellAt(1, 0).getValue()
+         << " , C1 = " << sheet.getCellAt(2, 0).getValue() << endl;
+
+    recomputed = engine.setValue(0, 3, 1); //A4 is not read by any formula
+    cout << "edit A4 recomputed " << recomputed << " cells" << endl;
+
+    try {
+        engine.setFormula(0, 0, "=MAX(C1, A3)"); //A1 -> C1 -> B1 -> A1
+    } catch (const CycleError& e) {
+        cout << "caught: " << e.what() << endl;
+    }
+    cout << "A1 still = " << sheet.getCellAt(0, 0).getValue() << endl;
+    try {
+        engine.setFormula(3, 0, "=SUM(A1:ZZZ99999999)"); //rejected before the range is expanded
+    } catch (const out_of_range& e) {
+        cout << "caught: " << e.what() << endl;
+    }
+}
+
+//1000 x 1000 = 1M cells : column A holds values , every other cell (x , y) = SUM(left neighbour , A(y))
+//editing A(y) dirties exactly one row (999 formula cells)
+//one more column (x = width) holds plain values no formula reads : the leaf edits go there
+void benchmark() {
+    constexpr size_t width = 1000;
+    constexpr size_t height = 1000;
+    Spreadsheet sheet(width + 1, height);
+    RecalcEngine engine(sheet);
+
+    auto start = chrono::steady_clock::now();
+    for (size_t y = 0; y < height; ++y) {
+        engine.setValue(0, y, 1);
+        const string rowName = to_string(y + 1);
+        for (size_t x = 1; x < width; ++x) {
+            engine.setFormula(x, y, "=SUM(" + cellName({ x - 1, y }) + ",A" + rowName + ")");
+        }
+    }
+    auto build = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "built " << engine.getFormulaCount() << " formulas in " << build << " s" << endl;
+
+    start = chrono::steady_clock::now();
+    engine.recalculateAll();
+    auto full = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "full recalculation      : " << full << " ms" << endl;
+
+    mt19937 gen(42);
+    uniform_int_distribution<size_t> row(0, height - 1);
+    constexpr int edits = 2000;
+    size_t recomputed = 0;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < edits; ++i) {
+        recomputed += engine.setValue(0, row(gen), i);
+    }
+    auto incremental = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / edits;
+    cout << "single-cell edit        : " << incremental << " us ("
+         << recomputed / edits << " cells recomputed per edit)" << endl;
+
+    //an edit nobody depends on : just the dependency lookup , the formula graph stays the same
+    size_t leafRecomputed = 0;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < edits; ++i) {
+        leafRecomputed += engine.setValue(width, row(gen), i);
+    }
+    auto leaf = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / edits;
+    cout << "edit without dependents : " << leaf << " us (" << leafRecomputed << " cells recomputed , "
+         << engine.getFormulaCount() << " formulas left)" << endl;
+}
+
+int main() {
+    smallExample();
+    benchmark();
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include "Person.h"
+#include "SlotMap.h"
+
+using namespace std;
+//g++ -std=c++20 -O3 -march=native slot_map.cpp -o slot_map
+
+void example() {
+    SlotMap<Person> people;
+    SlotHandle ahmed = people.emplace(1, "Ahmed");
+    SlotHandle nader = people.emplace(3, "Nader");
+    SlotHandle sayed = people.emplace(4, "Sayed");
+    people.at(ahmed).addFriendByUnvRef("jhon", "nader");
+
+    people.erase(nader); //Sayed is moved into Nader's place , his handle still works
+    cout << "sayed -> " << people.at(sayed).getName() << endl;
+    cout << "nader is stale : " << boolalpha << !people.contains(nader) << endl;
+
+    SlotHandle omar = people.emplace(5, "Omar"); //reuses Nader's slot with a new generation
+    cout << "same slot as nader : " << (omar.index() == nader.index()) << " , nader still stale : " << !people.contains(nader) << endl;
+
+    try {
+        people.at(nader);
+    } catch (const out_of_range& e) {
+        cout << "caught: " << e.what() << endl;
+    }
+
+    for (const Person& person : people) { //dense iteration
+        cout << person.getId() << " " << person.getName() << " (" << person.getFriends().size() << " friends)" << endl;
+    }
+}
+
+template <typename Function>
+double measure(Function f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+//slot map vs the usual "stable id" alternative : unordered_map<id , Person>
+void benchmark() {
+    constexpr int count = 1'000'000;
+    SlotMap<Person> slotMap;
+    unordered_map<int, Person> hashMap;
+    vector<SlotHandle> handles;
+    slotMap.reserve(count);
+    hashMap.reserve(count);
+
+    cout << "insert  slot map : " << measure([&] {
+        for (int i = 0; i < count; ++i) handles.push_back(slotMap.emplace(i, "person"));
+    }) << " ms" << endl;
+    cout << "insert  hash map : " << measure([&] {
+        for (int i = 0; i < count; ++i) hashMap.try_emplace(i, i, "person");
+    }) << " ms" << endl;
+
+    mt19937 gen(1);
+    shuffle(handles.begin(), handles.end(), gen);
+    long long sum = 0;
+    cout << "lookup  slot map : " << measure([&] {
+        for (SlotHandle h : handles) sum += slotMap.find(h)->getId();
+    }) << " ms" << endl;
+    cout << "lookup  hash map : " << measure([&] {
+        for (SlotHandle h : handles) sum += hashMap.find(static_cast<int>(h.index()))->second.getId();
+    }) << " ms" << endl;
+
+    cout << "iterate slot map : " << measure([&] {
+        for (const Person& p : slotMap) sum += p.getId();
+    }) << " ms" << endl;
+    cout << "iterate hash map : " << measure([&] {
+        for (const auto& [id, p] : hashMap) sum += p.getId();
+    }) << " ms" << endl;
+
+    cout << "erase half       : " << measure([&] {
+        for (size_t i = 0; i < handles.size() / 2; ++i) slotMap.erase(handles[i]);
+    }) << " ms" << endl;
+    size_t stale = 0;
+    for (SlotHandle h : handles) stale += !slotMap.contains(h);
+    cout << "stale handles detected : " << stale << " (checksum " << sum << ")" << endl;
+}
+
+int main() {
+    example();
+    benchmark();
+    return 0;
+}
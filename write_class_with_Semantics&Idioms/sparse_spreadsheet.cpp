@@ -0,0 +1,87 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "RecalcEngine.h"
+#include "SparseSpreadsheet.h"
+
+using namespace std;
+//g++ -std=c++20 -O3 -march=native sparse_spreadsheet.cpp -o sparse_spreadsheet
+
+void smallExample() {
+    SparseSpreadsheet sheet(100, 100);
+    sheet.setCellAt(7, 3, 1.5);
+    sheet.setCellAt(2, 3, 2.5);
+    sheet.setCellAt(50, 0, 3.5);
+    sheet.setCellAt(0, 99, 4.5);
+    cout << "E9 (empty) = " << as_const(sheet).getCellAt(4, 8).getValue() << endl;
+
+    cout << "non-empty cells in row-major order:" << endl;
+    sheet.forEachNonEmpty([](size_t x, size_t y, const SpreadsheetCell& cell) {
+        cout << "  (" << x << " , " << y << ") = " << cell.getValue() << endl;
+    });
+
+    //the formula engine works on the sparse backend too
+    BasicRecalcEngine<SparseSpreadsheet> engine(sheet);
+    engine.setFormula(99, 99, "=SUM(A1:Z100)"); //CV100
+    engine.setValue(2, 3, 10);
+    cout << "CV100 = SUM(A1:Z100) = " << as_const(sheet).getCellAt(99, 99).getValue()
+         << " , populated = " << sheet.getPopulatedCount() << endl;
+}
+
+void formulaExample() {
+    SparseSpreadsheet sheet(10'000, 1'000'000); //10^4 columns x 10^6 rows
+    BasicRecalcEngine<SparseSpreadsheet> engine(sheet);
+    engine.setValue(3, 500'000, 2);
+    engine.setValue(4, 500'000, 3);
+    engine.setFormula(9'999, 999'999, "=PRODUCT(D500001:E500001)");
+    engine.setValue(3, 500'000, 5);
+    cout << "last cell = PRODUCT(D500001:E500001) = " << as_const(sheet).getCellAt(9'999, 999'999).getValue()
+         << " , populated = " << sheet.getPopulatedCount() << endl;
+}
+
+//10^6 rows x 10^4 columns = 10^10 cells , dense would be 80 GB
+void memoryBenchmark() {
+    constexpr size_t width = 10'000;
+    constexpr size_t height = 1'000'000;
+    SparseSpreadsheet sheet(width, height);
+
+    mt19937_64 gen(7);
+    uniform_int_distribution<size_t> randomX(0, width - 1);
+    uniform_int_distribution<size_t> randomY(0, height - 1);
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < 1'000'000; ++i) { //scattered cells
+        sheet.setCellAt(randomX(gen), randomY(gen), 1.0);
+    }
+    for (size_t y = 0; y < 1000; ++y) { //a dense block : 1000 rows x 64 columns
+        for (size_t x = 0; x < 64; ++x) sheet.setCellAt(x, y, 2.0);
+    }
+    const double fill = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    double sum = 0;
+    size_t visited = 0;
+    sheet.forEachNonEmpty([&](size_t, size_t, const SpreadsheetCell& cell) {
+        sum += cell.getValue();
+        ++visited;
+    });
+    const double firstIterate = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now(); //the row-major key order is cached now
+    sheet.forEachNonEmpty([&](size_t, size_t, const SpreadsheetCell& cell) { sum += cell.getValue(); });
+    const double iterate = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    const double dense = static_cast<double>(width) * height * sizeof(SpreadsheetCell);
+    cout << "populated cells : " << sheet.getPopulatedCount() << " (visited " << visited << " , sum " << sum << ")" << endl;
+    cout << "sparse memory   : " << sheet.getMemoryUsage() / 1e6 << " MB ("
+         << static_cast<double>(sheet.getMemoryUsage()) / sheet.getPopulatedCount() << " bytes per cell)" << endl;
+    cout << "dense memory    : " << dense / 1e9 << " GB" << endl;
+    cout << "fill            : " << fill << " s" << endl;
+    cout << "row-major walk  : " << firstIterate << " ms (sorts the chunk keys) , then " << iterate << " ms" << endl;
+}
+
+int main() {
+    smallExample();
+    formulaExample();
+    memoryBenchmark();
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <vector>
+#include "Spreadsheet.h"
+
+using namespace std;
+//g++ -std=c++20 -O3 -march=native spreadsheet.cpp -o spreadsheet
+
+void printSheet(const Spreadsheet& sheet) {
+    for (size_t y = 0; y < sheet.getHeight(); ++y) {
+        for (const auto& cell : sheet.row(y)) {
+            cout << cell.getValue() << "\t";
+        }
+        cout << endl;
+    }
+}
+
+Spreadsheet createSheet(size_t width, size_t height) {
+    Spreadsheet sheet(width, height);
+    for (size_t y = 0; y < height; ++y) {
+        for (size_t x = 0; x < width; ++x) {
+            sheet.setCellAt(x, y, static_cast<double>(y * width + x));
+        }
+    }
+    return sheet; //NRVO or move constructor
+}
+
+int main() {
+    Spreadsheet sheet = createSheet(4, 3);
+    printSheet(sheet);
+
+    cout << "sum of row 1    : " << sheet.sumRow(1) << endl;
+    cout << "sum of column 2 : " << sheet.sumColumn(2) << endl;
+
+    vector<double> columnSums(sheet.getWidth());
+    sheet.sumColumns(columnSums);
+    cout << "column sums     : ";
+    for (double sum : columnSums) cout << sum << " ";
+    cout << endl;
+
+    /**************copy / move / swap****************/
+    Spreadsheet copySheet = sheet;             //copy constructor
+    Spreadsheet moveSheet = std::move(copySheet); //move constructor (noexcept)
+    Spreadsheet other(1, 1);
+    other = moveSheet;                         //copy-and-swap
+    other = Spreadsheet(2, 2);                 //move assignment (noexcept)
+    swap(other, moveSheet);
+    cout << "after swap other is " << other.getWidth() << "x" << other.getHeight() << endl;
+
+    /**************resize****************/
+    sheet.reserve(4 * 10);
+    sheet.resize(4, 2); //same width : no allocation , only the height changes
+    sheet.resize(4, 5); //still fits the capacity , rows 2..4 are zero
+    cout << "after resize(4 , 5) capacity = " << sheet.getCapacity() << endl;
+    printSheet(sheet);
+
+    sheet.resize(6, 2); //width changes : one new block , each kept row copied once
+    cout << "after resize(6 , 2)" << endl;
+    printSheet(sheet);
+
+    try {
+        sheet.getCellAt(6, 0);
+    } catch (const out_of_range& e) {
+        cout << "caught: " << e.what() << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include "SpreadsheetFile.h"
+
+using namespace std;
+//g++ -std=c++20 -O3 -march=native spreadsheet_file.cpp -o spreadsheet_file
+
+void roundTrip() {
+    Spreadsheet sheet(3, 3);
+    RecalcEngine engine(sheet);
+    engine.setValue(0, 0, 1.5);
+    engine.setValue(0, 1, 2.5);
+    engine.setFormula(1, 0, "=SUM(A1:A2)");
+    engine.setFormula(2, 2, "=MAX(A1, B1)");
+    saveSpreadsheet("small.sheet", sheet, &engine);
+
+    SpreadsheetFile file = SpreadsheetFile::open("small.sheet");
+    Spreadsheet loaded = file.sheet(); //no copy : reads the mapping
+    cout << "B1 = " << as_const(loaded).getCellAt(1, 0).getValue() << " , type " << static_cast<int>(file.getCellType(1, 0))
+         << " , text \"" << file.getFormulaText(1, 0) << "\" , view = " << loaded.isView() << endl;
+
+    //editing : formulas are parsed again , the first write copies the cells (copy-on-write)
+    RecalcEngine loadedEngine(loaded);
+    file.loadFormulas(loadedEngine);
+    loadedEngine.setValue(0, 1, 10);
+    cout << "after edit : B1 = " << loaded.getCellAt(1, 0).getValue() << " , C3 = " << loaded.getCellAt(2, 2).getValue()
+         << " , view = " << loaded.isView() << endl;
+    remove("small.sheet");
+}
+
+//open , then save the mapped view back to the same path : the usual "open , edit , save back" flow
+void saveBackToSameFile() {
+    Spreadsheet sheet(2, 2);
+    sheet.setCellAt(1, 1, 7.25);
+    saveSpreadsheet("same.sheet", sheet);
+
+    SpreadsheetFile file = SpreadsheetFile::open("same.sheet");
+    Spreadsheet view = file.sheet();
+    saveSpreadsheet("same.sheet", view); //written next to it , renamed over it : the mapping is untouched
+    SpreadsheetFile again = SpreadsheetFile::open("same.sheet");
+    const Spreadsheet reopened = again.sheet();
+    const bool same = reopened.getCellAt(1, 1).getValue() == 7.25 &&
+                      as_const(view).getCellAt(1, 1).getValue() == 7.25 && view.isView();
+    cout << "saved a mapped view onto its own file : " << (same ? "ok" : "FAILED") << endl;
+    remove("same.sheet");
+}
+
+//a valid file with a crafted header : sizes that only fit once a uint64 wraps around must be rejected
+bool rejectsCraftedHeader(void (*craft)(SpreadsheetFileHeader&)) {
+    Spreadsheet sheet(3, 3);
+    saveSpreadsheet("crafted.sheet", sheet);
+    SpreadsheetFileHeader header;
+    {
+        fstream file("crafted.sheet", ios::binary | ios::in | ios::out);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        craft(header);
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    bool rejected = false;
+    try {
+        SpreadsheetFile::open("crafted.sheet");
+    } catch (const runtime_error&) {
+        rejected = true;
+    }
+    remove("crafted.sheet");
+    return rejected;
+}
+
+void craftedHeaders() {
+    //width * height = 2^61 : cellCount * sizeof(double) wraps to 0 , stringsOffset + stringsSize wraps to 0
+    const bool cells = rejectsCraftedHeader([](SpreadsheetFileHeader& h) {
+        h.width = uint64_t{1} << 31;
+        h.height = uint64_t{1} << 30;
+        h.valuesOffset = (uint64_t{1} << 61) + 128;
+        h.formulaCount = 0;
+        h.formulasOffset = h.valuesOffset;
+        h.stringsOffset = h.valuesOffset;
+        h.stringsSize = 0 - h.stringsOffset;
+    });
+    //a string heap "ending" 1 byte into the file
+    const bool strings = rejectsCraftedHeader([](SpreadsheetFileHeader& h) { h.stringsSize = 1 - h.stringsOffset; });
+    cout << "crafted headers rejected : cells " << (cells ? "ok" : "FAILED") << " , strings "
+         << (strings ? "ok" : "FAILED") << endl;
+}
+
+void openBenchmark() {
+    constexpr size_t width = 4000;
+    constexpr size_t height = 4000; //16M cells , ~144 MB file
+    {
+        Spreadsheet sheet(width, height);
+        for (size_t y = 0; y < height; ++y) {
+            for (auto& cell : sheet.row(y)) cell.setValue(static_cast<double>(y));
+        }
+        auto start = chrono::steady_clock::now();
+        saveSpreadsheet("big.sheet", sheet);
+        cout << "save               : " << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms" << endl;
+    }
+
+    auto start = chrono::steady_clock::now();
+    SpreadsheetFile file = SpreadsheetFile::open("big.sheet");
+    Spreadsheet sheet = file.sheet();
+    cout << "open + view        : " << chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() << " us" << endl;
+
+    start = chrono::steady_clock::now();
+    const double last = as_const(sheet).getCellAt(width - 1, height - 1).getValue();
+    cout << "read one cell      : " << chrono::duration<double, micro>(chrono::steady_clock::now() - start).count()
+         << " us (value " << last << ")" << endl;
+
+    start = chrono::steady_clock::now();
+    vector<double> sums(width);
+    as_const(sheet).sumColumns(sums);
+    cout << "sum every column   : " << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count()
+         << " ms (pages are faulted in on demand)" << endl;
+
+    start = chrono::steady_clock::now();
+    sheet.setCellAt(0, 0, 42); //first edit : copy into owned storage
+    cout << "first edit (COW)   : " << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms" << endl;
+    start = chrono::steady_clock::now();
+    sheet.setCellAt(1, 0, 43);
+    cout << "second edit        : " << chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() << " us" << endl;
+    remove("big.sheet");
+}
+
+int main() {
+    try {
+        roundTrip();
+        saveBackToSameFile();
+        craftedHeaders();
+        openBenchmark();
+    } catch (const exception& e) {
+        cerr << "error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}